@@ -14,6 +14,10 @@
 #include <dcp/model/pdu/DcpPdu.hpp>
 #include <dcp/logic/DcpManager.hpp>
 
+#include <chrono>
+#include <functional>
+#include <vector>
+
 /**
  * Interface for a DCP driver.
  * A DCP driver maps the PDUs to transport protocol and
@@ -109,6 +113,21 @@ struct DcpDriver{
     * The DCP driver should stop listening to the transport protocol
     */
     std::function<void()> stopReceiving;
+    /**
+     * Sending the given PDUs over transport protocol, in the given order.
+     * Drivers can use this to hand several PDUs to the transport protocol at once.
+     * Optional: if not set, callers fall back to send for each PDU.
+     *
+     * @pre same as for send
+     */
+    std::function<void(std::vector<DcpPdu*>&)> sendBatch;
+    /**
+     * Arms the deadline timer of the driver. The callback is called on the receive thread
+     * when the deadline is reached. Arming again replaces a pending deadline, an empty
+     * callback cancels it.
+     * Optional: if not set, a slave supervises its heartbeat on an own thread.
+     */
+    std::function<void(std::chrono::steady_clock::time_point, std::function<void()>)> armTimer;
 };
 
 #endif //DCPLIB_DCPDRIVER_H
\ No newline at end of file
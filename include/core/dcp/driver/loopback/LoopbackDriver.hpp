@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_LOOPBACKDRIVER_HPP
+#define DCPLIB_LOOPBACKDRIVER_HPP
+
+#include <dcp/driver/DcpDriver.hpp>
+#include <dcp/helper/BufferPool.hpp>
+#include <dcp/logic/CallbackExecutor.hpp>
+#include <dcp/logic/Logable.hpp>
+#include <dcp/model/DcpTypes.hpp>
+#include <dcp/model/pdu/DcpPduBasic.hpp>
+#include <dcp/model/pdu/DcpPduDatInputOutput.hpp>
+#include <dcp/model/pdu/DcpPduDatParameter.hpp>
+#include <dcp/model/pdu/DcpPduFactory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace internal {
+    struct LoopbackDatagram {
+        PooledBuffer buffer;
+        //size of the PDU, which starts behind the length indicator
+        size_t size;
+        uint64_t source;
+        uint64_t destination;
+    };
+
+    /**
+     * Receive queue of one LoopbackDriver. Any thread may push, only the receive thread of the driver pops.
+     * The receive thread also runs the deadline timer of the driver.
+     */
+    class LoopbackInbox {
+    public:
+        enum class Event {
+            DATAGRAM, TIMER, STOPPED
+        };
+
+        explicit LoopbackInbox(size_t capacity) : queue(capacity), sleeping(false), stopped(false) {}
+
+        /**
+         * @return False if the inbox is full. The datagram is dropped then.
+         */
+        bool push(LoopbackDatagram &datagram) {
+            if (!queue.push(datagram)) {
+                return false;
+            }
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping.load()) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cv.notify_one();
+            }
+            return true;
+        }
+
+        /**
+         * Blocks until a datagram arrives, the armed deadline is reached or the inbox is stopped.
+         */
+        Event wait(LoopbackDatagram &datagram, std::function<void()> &timerCallback) {
+            if (queue.pop(datagram)) {
+                return Event::DATAGRAM;
+            }
+            std::unique_lock<std::mutex> lock(mtx);
+            while (true) {
+                if (stopped) {
+                    return Event::STOPPED;
+                }
+                if (callback && std::chrono::steady_clock::now() >= deadline) {
+                    timerCallback = std::move(callback);
+                    callback = nullptr;
+                    return Event::TIMER;
+                }
+                sleeping = true;
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!queue.pop(datagram)) {
+                    if (callback) {
+                        cv.wait_until(lock, deadline);
+                    } else {
+                        cv.wait(lock);
+                    }
+                    sleeping = false;
+                    if (!queue.pop(datagram)) {
+                        continue;
+                    }
+                }
+                sleeping = false;
+                return Event::DATAGRAM;
+            }
+        }
+
+        void arm(std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+            std::lock_guard<std::mutex> lock(mtx);
+            this->deadline = deadline;
+            this->callback = std::move(callback);
+            cv.notify_one();
+        }
+
+        void stop() {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopped = true;
+            cv.notify_one();
+        }
+
+        void restart() {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopped = false;
+        }
+
+    private:
+        BoundedMpmcQueue<LoopbackDatagram> queue;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::atomic_bool sleeping;
+        bool stopped;
+        std::chrono::steady_clock::time_point deadline;
+        std::function<void()> callback;
+    };
+
+    /**
+     * Address of the loopback broker. Addresses are never removed, so drivers may keep pointers to them.
+     */
+    struct LoopbackAddress {
+        explicit LoopbackAddress(uint64_t key) : key(key), inbox(nullptr) {}
+
+        const uint64_t key;
+        std::atomic<LoopbackInbox *> inbox;
+    };
+}
+
+/**
+ * Routes PDUs between LoopbackDrivers in one process, e.g. a DcpManagerMaster and its slaves.
+ * Drivers are addressed like UDP_IPv4 endpoints. An address with ip 0.0.0.0 receives everything
+ * sent to its port which has no exact match. PDUs are queued in lock free inboxes; a full inbox
+ * drops the PDU, as a socket would.
+ * The broker has to outlive all its drivers.
+ */
+class LoopbackBroker {
+public:
+    /**
+     * @param inboxCapacity Number of PDUs each driver can queue
+     * @param bufferSize Size of the pooled PDU buffers. Larger PDUs get own buffers.
+     */
+    explicit LoopbackBroker(size_t inboxCapacity = 1024, size_t bufferSize = 1028) : inboxCapacity(inboxCapacity),
+                                                                                     pool(bufferSize),
+                                                                                     dropped(0) {}
+
+    LoopbackBroker(const LoopbackBroker &) = delete;
+
+    LoopbackBroker &operator=(const LoopbackBroker &) = delete;
+
+    static uint64_t key(ip_address_t ip, port_t port) {
+        return ((uint64_t) ip << 16) | port;
+    }
+
+    /**
+     * @return The address for key. Created if it does not exist.
+     */
+    internal::LoopbackAddress *resolve(uint64_t key) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::unique_ptr<internal::LoopbackAddress> &address = addresses[key];
+        if (address == nullptr) {
+            address = std::unique_ptr<internal::LoopbackAddress>(new internal::LoopbackAddress(key));
+        }
+        return address.get();
+    }
+
+    /**
+     * @return False if key is already bound to another inbox
+     */
+    bool bind(uint64_t key, internal::LoopbackInbox *inbox) {
+        internal::LoopbackInbox *expected = nullptr;
+        internal::LoopbackAddress *address = resolve(key);
+        return address->inbox.compare_exchange_strong(expected, inbox) || expected == inbox;
+    }
+
+    void unbind(uint64_t key, internal::LoopbackInbox *inbox) {
+        resolve(key)->inbox.compare_exchange_strong(inbox, nullptr);
+    }
+
+    /**
+     * Queues datagram at address, or at wildcard if address is not bound.
+     * @return False if the PDU was dropped
+     */
+    bool deliver(internal::LoopbackAddress *address, internal::LoopbackAddress *wildcard,
+                 internal::LoopbackDatagram &datagram) {
+        internal::LoopbackInbox *inbox = address->inbox.load(std::memory_order_acquire);
+        datagram.destination = address->key;
+        if (inbox == nullptr && wildcard != nullptr) {
+            inbox = wildcard->inbox.load(std::memory_order_acquire);
+            datagram.destination = wildcard->key;
+        }
+        if (inbox == nullptr || !inbox->push(datagram)) {
+            dropped++;
+            return false;
+        }
+        return true;
+    }
+
+    PooledBuffer acquire(size_t size) {
+        return pool.acquire(size);
+    }
+
+    size_t getInboxCapacity() const {
+        return inboxCapacity;
+    }
+
+    /**
+     * @return Number of PDUs dropped because of an unbound address or a full inbox
+     */
+    uint64_t getDroppedPdus() const {
+        return dropped;
+    }
+
+private:
+    const size_t inboxCapacity;
+    BufferPool pool;
+    std::atomic<uint64_t> dropped;
+    std::mutex mtx;
+    std::map<uint64_t, std::unique_ptr<internal::LoopbackAddress>> addresses;
+};
+
+/**
+ * DcpDriver which exchanges PDUs in memory through a LoopbackBroker.
+ * The network information has the format of UDP_IPv4, so masters and slaves configured
+ * for UDP_IPv4 can be used unchanged. Sending copies the PDU once into a pooled buffer,
+ * which is handed to the receiving manager without further copies.
+ * PDUs of one sender to one receiver are delivered in order.
+ */
+class LoopbackDriver : public Logable {
+public:
+    LoopbackDriver(LoopbackBroker &broker, std::string host, uint16_t port) : broker(broker),
+                                                                             inbox(broker.getInboxCapacity()) {
+        mainKey = LoopbackBroker::key(parseIp(host), port);
+    }
+
+    ~LoopbackDriver() {
+        inbox.stop();
+        closeConfiguredPorts();
+        broker.unbind(mainKey, &inbox);
+    }
+
+    DcpDriver getDcpDriver() {
+        return {[this](DcpPdu &msg) { this->send(msg); },
+                [this](dcpId_t dcpId, uint8_t *info) {
+                    otherSlaves[dcpId] = target(*((uint16_t *) info), *((ip_address_t *) (info + 2)));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioIn[dataId] = LoopbackBroker::key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioOut[dataId] = target(*((uint16_t *) info), *((ip_address_t *) (info + 2)));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramIn[paramId] = LoopbackBroker::key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramOut[paramId] = target(*((uint16_t *) info), *((ip_address_t *) (info + 2)));
+                },
+                std::bind(&LoopbackDriver::startReceiving, this),
+                [this](dcpId_t) {/*nothing to do for connectionless loopback*/ },
+                [this](dcpId_t) {/*nothing to do for connectionless loopback*/ },
+                [this](DcpManager manager) {
+                    this->dcpManager = manager;
+                },
+                [this](const LogManager &logManager) {
+                    setLogManager(logManager);
+                },
+                [this]() { masterTarget = lastAccessTarget(); },
+                std::bind(&LoopbackDriver::openPorts, this),
+                [this]() {/*nothing to do for connectionless loopback*/ },
+                std::bind(&LoopbackDriver::closeConfiguredPorts, this),
+                [this]() {/*nothing to do for connectionless loopback*/ },
+                [this]() { inbox.stop(); },
+                nullptr,
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    inbox.arm(deadline, std::move(callback));
+                }
+        };
+    }
+
+private:
+    struct Target {
+        internal::LoopbackAddress *address = nullptr;
+        internal::LoopbackAddress *wildcard = nullptr;
+    };
+
+    LoopbackBroker &broker;
+    internal::LoopbackInbox inbox;
+    DcpManager dcpManager;
+    uint64_t mainKey;
+
+    Target masterTarget;
+    //source of the last PDU received on the main address
+    std::atomic<uint64_t> lastAccess{0};
+    //responses may be sent from several threads
+    std::mutex mtxLastAccess;
+    Target lastAccessCache;
+
+    std::map<dcpId_t, Target> otherSlaves;
+    std::map<dataId_t, Target> ioOut;
+    std::map<paramId_t, Target> paramOut;
+    std::map<dataId_t, uint64_t> ioIn;
+    std::map<paramId_t, uint64_t> paramIn;
+    std::set<uint64_t> bound;
+
+    static ip_address_t parseIp(const std::string &host) {
+        unsigned int a = 0, b = 0, c = 0, d = 0;
+        std::sscanf(host.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d);
+        return (ip_address_t) ((a << 24) | (b << 16) | (c << 8) | d);
+    }
+
+    Target target(port_t port, ip_address_t ip) {
+        Target target;
+        target.address = broker.resolve(LoopbackBroker::key(ip, port));
+        target.wildcard = broker.resolve(LoopbackBroker::key(0, port));
+        return target;
+    }
+
+    Target lastAccessTarget() {
+        std::lock_guard<std::mutex> lock(mtxLastAccess);
+        uint64_t key = lastAccess.load(std::memory_order_relaxed);
+        if (lastAccessCache.address == nullptr || lastAccessCache.address->key != key) {
+            lastAccessCache = target((port_t) (key & 0xFFFF), (ip_address_t) (key >> 16));
+        }
+        return lastAccessCache;
+    }
+
+    template<typename K>
+    static Target find(const std::map<K, Target> &targets, K key) {
+        auto it = targets.find(key);
+        return it != targets.end() ? it->second : Target();
+    }
+
+    /**
+     * Does not insert into the target maps, so sending from several threads is safe.
+     */
+    Target getTarget(DcpPdu &msg) {
+        switch (msg.getTypeId()) {
+            case DcpPduType::DAT_input_output:
+                return find(ioOut, static_cast<DcpPduDatInputOutput &>(msg).getDataId());
+            case DcpPduType::DAT_parameter:
+                return find(paramOut, static_cast<DcpPduDatParameter &>(msg).getParamId());
+            case DcpPduType::NTF_state_changed:
+            case DcpPduType::NTF_log:
+                return masterTarget;
+            case DcpPduType::RSP_ack:
+            case DcpPduType::RSP_nack:
+            case DcpPduType::RSP_state_ack:
+            case DcpPduType::RSP_error_ack:
+            case DcpPduType::RSP_log_ack:
+                return lastAccessTarget();
+            default:
+                return find(otherSlaves, static_cast<DcpPduBasic &>(msg).getReceiver());
+        }
+    }
+
+    void send(DcpPdu &msg) {
+        Target target = getTarget(msg);
+        if (target.address == nullptr) {
+            return;
+        }
+        internal::LoopbackDatagram datagram;
+        datagram.size = msg.getPduSize();
+        datagram.buffer = broker.acquire(datagram.size + 4);
+        std::memcpy(datagram.buffer.data() + 4, msg.serializePdu(), datagram.size);
+        datagram.source = mainKey;
+        broker.deliver(target.address, target.wildcard, datagram);
+    }
+
+    void startReceiving() {
+        if (!broker.bind(mainKey, &inbox)) {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+            return;
+        }
+        inbox.restart();
+        internal::LoopbackDatagram datagram;
+        std::function<void()> timerCallback;
+        while (true) {
+            switch (inbox.wait(datagram, timerCallback)) {
+                case internal::LoopbackInbox::Event::STOPPED:
+                    return;
+                case internal::LoopbackInbox::Event::TIMER:
+                    timerCallback();
+                    timerCallback = nullptr;
+                    break;
+                case internal::LoopbackInbox::Event::DATAGRAM: {
+                    if (datagram.destination == mainKey) {
+                        lastAccess.store(datagram.source, std::memory_order_relaxed);
+                    }
+                    DcpPduSlot slot;
+                    DcpPdu &pdu = slot.emplace(datagram.buffer.data(), datagram.size);
+                    if (dcpManager.receiveBuffer) {
+                        dcpManager.receiveBuffer(pdu, datagram.buffer);
+                    } else {
+                        dcpManager.receive(pdu);
+                    }
+                    datagram.buffer = PooledBuffer();
+                    break;
+                }
+            }
+        }
+    }
+
+    void openPorts() {
+        for (auto &pos : ioIn) {
+            bindPort(pos.second);
+        }
+        for (auto &pos : paramIn) {
+            bindPort(pos.second);
+        }
+    }
+
+    void bindPort(uint64_t key) {
+        //the main address also receives PDUs for its port if it is a wildcard address
+        if (key == mainKey || (mainKey >> 16 == 0 && (mainKey & 0xFFFF) == (key & 0xFFFF)) || bound.count(key)) {
+            return;
+        }
+        if (broker.bind(key, &inbox)) {
+            bound.insert(key);
+        } else {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+        }
+    }
+
+    void closeConfiguredPorts() {
+        for (uint64_t key : bound) {
+            broker.unbind(key, &inbox);
+        }
+        bound.clear();
+        ioIn.clear();
+        paramIn.clear();
+    }
+};
+
+#endif //DCPLIB_LOOPBACKDRIVER_HPP
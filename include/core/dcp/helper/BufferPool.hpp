@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_BUFFERPOOL_HPP
+#define DCPLIB_BUFFERPOOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace internal {
+    struct PoolState;
+
+    struct PoolBuffer {
+        PoolBuffer(PoolState *pool, size_t capacity) : refs(0), pool(pool), capacity(capacity),
+                                                       data(new uint8_t[capacity]) {}
+
+        std::atomic<uint32_t> refs;
+        //nullptr for buffers larger than the pool buffers, they are deleted on release
+        PoolState *pool;
+        size_t capacity;
+        std::unique_ptr<uint8_t[]> data;
+    };
+
+    /**
+     * Free list of a BufferPool. Outlives the pool until the last buffer is released.
+     */
+    struct PoolState {
+        explicit PoolState(size_t bufferSize) : bufferSize(bufferSize), allocated(0), closed(false) {}
+
+        ~PoolState() {
+            for (PoolBuffer *buffer : free) {
+                delete buffer;
+            }
+        }
+
+        void release(PoolBuffer *buffer) {
+            bool last = false;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (closed) {
+                    delete buffer;
+                    last = --allocated == 0;
+                } else {
+                    free.push_back(buffer);
+                }
+            }
+            if (last) {
+                delete this;
+            }
+        }
+
+        const size_t bufferSize;
+        std::mutex mtx;
+        std::vector<PoolBuffer *> free;
+        size_t allocated;
+        bool closed;
+    };
+}
+
+/**
+ * Reference counted handle to a buffer of a BufferPool.
+ * Copies share the buffer. The buffer returns to its pool when the last handle is destroyed.
+ */
+class PooledBuffer {
+public:
+    PooledBuffer() : buffer(nullptr) {}
+
+    explicit PooledBuffer(internal::PoolBuffer *buffer) : buffer(buffer) {
+        if (buffer != nullptr) {
+            buffer->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PooledBuffer(const PooledBuffer &other) : PooledBuffer(other.buffer) {}
+
+    PooledBuffer(PooledBuffer &&other) noexcept : buffer(other.buffer) {
+        other.buffer = nullptr;
+    }
+
+    PooledBuffer &operator=(PooledBuffer other) {
+        std::swap(buffer, other.buffer);
+        return *this;
+    }
+
+    ~PooledBuffer() {
+        if (buffer != nullptr && buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (buffer->pool != nullptr) {
+                buffer->pool->release(buffer);
+            } else {
+                delete buffer;
+            }
+        }
+    }
+
+    uint8_t *data() const {
+        return buffer->data.get();
+    }
+
+    size_t capacity() const {
+        return buffer->capacity;
+    }
+
+    /**
+     * @return Number of handles sharing the buffer. 0 for an empty handle.
+     */
+    uint32_t useCount() const {
+        return buffer == nullptr ? 0 : buffer->refs.load(std::memory_order_acquire);
+    }
+
+    explicit operator bool() const {
+        return buffer != nullptr;
+    }
+
+private:
+    internal::PoolBuffer *buffer;
+};
+
+/**
+ * Part of a pooled buffer, e.g. the payload of a received PDU. Keeps the buffer alive.
+ */
+class PayloadSlice {
+public:
+    PayloadSlice() : ptr(nullptr), length(0) {}
+
+    /**
+     * @param data Begin of the slice, has to lie in buffer
+     */
+    PayloadSlice(PooledBuffer buffer, uint8_t *data, size_t size) : buffer(std::move(buffer)), ptr(data),
+                                                                     length(size) {}
+
+    uint8_t *data() const {
+        return ptr;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    PooledBuffer buffer;
+    uint8_t *ptr;
+    size_t length;
+};
+
+/**
+ * Pool of equally sized buffers which are handed out as reference counted PooledBuffer.
+ * Buffers are allocated on demand and reused once all handles to them are dropped.
+ * The pool may be destroyed while buffers are still referenced.
+ */
+class BufferPool {
+public:
+    explicit BufferPool(size_t bufferSize) : state(new internal::PoolState(bufferSize)) {}
+
+    ~BufferPool() {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(state->mtx);
+            state->closed = true;
+            for (internal::PoolBuffer *buffer : state->free) {
+                delete buffer;
+            }
+            state->allocated -= state->free.size();
+            state->free.clear();
+            last = state->allocated == 0;
+        }
+        if (last) {
+            delete state;
+        }
+    }
+
+    BufferPool(const BufferPool &) = delete;
+
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    /**
+     * @param size Minimum capacity. Larger requests than the buffer size get an own, not pooled buffer.
+     */
+    PooledBuffer acquire(size_t size = 0) {
+        if (size > state->bufferSize) {
+            return PooledBuffer(new internal::PoolBuffer(nullptr, size));
+        }
+        std::lock_guard<std::mutex> lock(state->mtx);
+        if (state->free.empty()) {
+            state->allocated++;
+            return PooledBuffer(new internal::PoolBuffer(state, state->bufferSize));
+        }
+        internal::PoolBuffer *buffer = state->free.back();
+        state->free.pop_back();
+        return PooledBuffer(buffer);
+    }
+
+    /**
+     * Copies size bytes of data into a pooled buffer.
+     */
+    PayloadSlice copy(const uint8_t *data, size_t size) {
+        PooledBuffer buffer = acquire(size);
+        std::memcpy(buffer.data(), data, size);
+        uint8_t *begin = buffer.data();
+        return PayloadSlice(std::move(buffer), begin, size);
+    }
+
+    /**
+     * @return Number of pooled buffers allocated so far
+     */
+    size_t getAllocated() {
+        std::lock_guard<std::mutex> lock(state->mtx);
+        return state->allocated;
+    }
+
+private:
+    internal::PoolState *state;
+};
+
+#endif //DCPLIB_BUFFERPOOL_HPP
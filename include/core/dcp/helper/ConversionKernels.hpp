@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universität Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_CONVERSIONKERNELS_HPP
+#define DCPLIB_CONVERSIONKERNELS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <dcp/helper/Helper.hpp>
+#include <dcp/model/constant/DcpDataType.hpp>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+#define DCPLIB_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * Converts count consecutive values of the source data type to the target data type.
+ * Source and destination do not need to be aligned.
+ */
+typedef void (*ConversionKernel)(uint8_t *destination, const uint8_t *source, size_t count);
+
+template<typename T1, typename T2>
+static void convertValues(uint8_t *destination, const uint8_t *source, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        T2 value;
+        std::memcpy(&value, source + i * sizeof(T2), sizeof(T2));
+        T1 converted = (T1) value;
+        std::memcpy(destination + i * sizeof(T1), &converted, sizeof(T1));
+    }
+}
+
+template<typename T>
+static void copyValues(uint8_t *destination, const uint8_t *source, size_t count) {
+    std::memcpy(destination, source, count * sizeof(T));
+}
+
+#ifdef DCPLIB_X86_KERNELS
+/*
+ * Widening conversions to float32 and float64. The vector loops handle full lanes,
+ * the remaining elements are converted by convertValues.
+ */
+
+__attribute__((target("sse4.1"))) static inline __m128i sseLoad4Epi32(const uint8_t *p, int8_t) {
+    int32_t v;
+    std::memcpy(&v, p, 4);
+    return _mm_cvtepi8_epi32(_mm_cvtsi32_si128(v));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i sseLoad4Epi32(const uint8_t *p, uint8_t) {
+    int32_t v;
+    std::memcpy(&v, p, 4);
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(v));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i sseLoad4Epi32(const uint8_t *p, int16_t) {
+    return _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i sseLoad4Epi32(const uint8_t *p, uint16_t) {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+__attribute__((target("sse4.1"))) static inline __m128i sseLoad4Epi32(const uint8_t *p, int32_t) {
+    return _mm_loadu_si128((const __m128i *) p);
+}
+
+template<typename T2>
+__attribute__((target("sse4.1"))) static void widenToFloat32Sse(uint8_t *destination, const uint8_t *source,
+                                                                 size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = sseLoad4Epi32(source + i * sizeof(T2), T2());
+        _mm_storeu_ps((float *) (destination + i * 4), _mm_cvtepi32_ps(v));
+    }
+    convertValues<float32_t, T2>(destination + i * 4, source + i * sizeof(T2), count - i);
+}
+
+template<typename T2>
+__attribute__((target("sse4.1"))) static void widenToFloat64Sse(uint8_t *destination, const uint8_t *source,
+                                                                 size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = sseLoad4Epi32(source + i * sizeof(T2), T2());
+        _mm_storeu_pd((double *) (destination + i * 8), _mm_cvtepi32_pd(v));
+        _mm_storeu_pd((double *) (destination + i * 8 + 16), _mm_cvtepi32_pd(_mm_unpackhi_epi64(v, v)));
+    }
+    convertValues<float64_t, T2>(destination + i * 8, source + i * sizeof(T2), count - i);
+}
+
+static void float32ToFloat64Sse(uint8_t *destination, const uint8_t *source, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps((const float *) (source + i * 4));
+        _mm_storeu_pd((double *) (destination + i * 8), _mm_cvtps_pd(v));
+        _mm_storeu_pd((double *) (destination + i * 8 + 16), _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+    convertValues<float64_t, float32_t>(destination + i * 8, source + i * 4, count - i);
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2Load8Epi32(const uint8_t *p, int8_t) {
+    return _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2Load8Epi32(const uint8_t *p, uint8_t) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) p));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2Load8Epi32(const uint8_t *p, int16_t) {
+    return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) p));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2Load8Epi32(const uint8_t *p, uint16_t) {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) p));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2Load8Epi32(const uint8_t *p, int32_t) {
+    return _mm256_loadu_si256((const __m256i *) p);
+}
+
+template<typename T2>
+__attribute__((target("avx2"))) static void widenToFloat32Avx2(uint8_t *destination, const uint8_t *source,
+                                                                size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = avx2Load8Epi32(source + i * sizeof(T2), T2());
+        _mm256_storeu_ps((float *) (destination + i * 4), _mm256_cvtepi32_ps(v));
+    }
+    convertValues<float32_t, T2>(destination + i * 4, source + i * sizeof(T2), count - i);
+}
+
+template<typename T2>
+__attribute__((target("avx2"))) static void widenToFloat64Avx2(uint8_t *destination, const uint8_t *source,
+                                                                size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = avx2Load8Epi32(source + i * sizeof(T2), T2());
+        _mm256_storeu_pd((double *) (destination + i * 8), _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)));
+        _mm256_storeu_pd((double *) (destination + i * 8 + 32), _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)));
+    }
+    convertValues<float64_t, T2>(destination + i * 8, source + i * sizeof(T2), count - i);
+}
+
+__attribute__((target("avx2"))) static void float32ToFloat64Avx2(uint8_t *destination, const uint8_t *source,
+                                                                  size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm256_storeu_pd((double *) (destination + i * 8), _mm256_cvtps_pd(_mm_loadu_ps((const float *) (source + i * 4))));
+    }
+    convertValues<float64_t, float32_t>(destination + i * 8, source + i * 4, count - i);
+}
+
+#define SIMD_KERNEL_CASE(val, T2, kernel) \
+        case DcpDataType::val : \
+            return &kernel<T2>;
+
+/**
+ * Returns a vectorized kernel for the conversion, if the running cpu supports one.
+ * @return the kernel or nullptr
+ */
+static ConversionKernel getSimdConversionKernel(DcpDataType targetDataType, DcpDataType sourceDataType) {
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    switch (targetDataType) {
+        case DcpDataType::float32:
+            if (avx2) {
+                switch (sourceDataType) {
+                    SIMD_KERNEL_CASE(int8, int8_t, widenToFloat32Avx2)
+                    SIMD_KERNEL_CASE(int16, int16_t, widenToFloat32Avx2)
+                    SIMD_KERNEL_CASE(uint8, uint8_t, widenToFloat32Avx2)
+                    SIMD_KERNEL_CASE(uint16, uint16_t, widenToFloat32Avx2)
+                    default:
+                        break;
+                }
+            } else if (sse41) {
+                switch (sourceDataType) {
+                    SIMD_KERNEL_CASE(int8, int8_t, widenToFloat32Sse)
+                    SIMD_KERNEL_CASE(int16, int16_t, widenToFloat32Sse)
+                    SIMD_KERNEL_CASE(uint8, uint8_t, widenToFloat32Sse)
+                    SIMD_KERNEL_CASE(uint16, uint16_t, widenToFloat32Sse)
+                    default:
+                        break;
+                }
+            }
+            break;
+        case DcpDataType::float64:
+            if (avx2) {
+                switch (sourceDataType) {
+                    SIMD_KERNEL_CASE(int8, int8_t, widenToFloat64Avx2)
+                    SIMD_KERNEL_CASE(int16, int16_t, widenToFloat64Avx2)
+                    SIMD_KERNEL_CASE(int32, int32_t, widenToFloat64Avx2)
+                    SIMD_KERNEL_CASE(uint8, uint8_t, widenToFloat64Avx2)
+                    SIMD_KERNEL_CASE(uint16, uint16_t, widenToFloat64Avx2)
+                    case DcpDataType::float32:
+                        return &float32ToFloat64Avx2;
+                    default:
+                        break;
+                }
+            } else {
+                if (sourceDataType == DcpDataType::float32) {
+                    return &float32ToFloat64Sse;
+                }
+                if (sse41) {
+                    switch (sourceDataType) {
+                        SIMD_KERNEL_CASE(int8, int8_t, widenToFloat64Sse)
+                        SIMD_KERNEL_CASE(int16, int16_t, widenToFloat64Sse)
+                        SIMD_KERNEL_CASE(int32, int32_t, widenToFloat64Sse)
+                        SIMD_KERNEL_CASE(uint8, uint8_t, widenToFloat64Sse)
+                        SIMD_KERNEL_CASE(uint16, uint16_t, widenToFloat64Sse)
+                        default:
+                            break;
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
+#endif
+
+#define KERNEL_CASE(val, T1, T2) \
+        case DcpDataType::val : \
+            return &convertValues<T1, T2>;
+
+#define KERNEL_SWITCH_START switch(sourceDataType){
+#define KERNEL_SWITCH_END \
+        default: \
+        break;\
+    } \
+    break;
+
+/**
+ * Returns the scalar kernel converting fixed size values of sourceDataType to targetDataType.
+ * The allowed conversions are the same as in MultiDimValue::update.
+ * @return the kernel, or nullptr if the types are variable sized or the conversion is not allowed
+ */
+static ConversionKernel getScalarConversionKernel(DcpDataType targetDataType, DcpDataType sourceDataType) {
+    if (targetDataType == sourceDataType) {
+        switch (targetDataType) {
+            case DcpDataType::uint8:
+            case DcpDataType::int8:
+                return &copyValues<uint8_t>;
+            case DcpDataType::uint16:
+            case DcpDataType::int16:
+                return &copyValues<uint16_t>;
+            case DcpDataType::uint32:
+            case DcpDataType::int32:
+            case DcpDataType::float32:
+                return &copyValues<uint32_t>;
+            case DcpDataType::uint64:
+            case DcpDataType::int64:
+            case DcpDataType::float64:
+                return &copyValues<uint64_t>;
+            default:
+                return nullptr;
+        }
+    }
+    switch (targetDataType) {
+        case DcpDataType::uint16:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(uint8, uint16_t, uint8_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::uint32:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(uint8, uint32_t, uint8_t)
+                KERNEL_CASE(uint16, uint32_t, uint16_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::uint64:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(uint8, uint64_t, uint8_t)
+                KERNEL_CASE(uint16, uint64_t, uint16_t)
+                KERNEL_CASE(uint32, uint64_t, uint32_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::int16:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(int8, int16_t, int8_t)
+                KERNEL_CASE(uint8, int16_t, uint8_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::int32:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(int8, int32_t, int8_t)
+                KERNEL_CASE(int16, int32_t, int16_t)
+                KERNEL_CASE(uint8, int32_t, uint8_t)
+                KERNEL_CASE(uint16, int32_t, uint16_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::int64:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(int8, int64_t, int8_t)
+                KERNEL_CASE(int16, int64_t, int16_t)
+                KERNEL_CASE(int32, int64_t, int32_t)
+                KERNEL_CASE(uint8, int64_t, uint8_t)
+                KERNEL_CASE(uint16, int64_t, uint16_t)
+                KERNEL_CASE(uint32, int64_t, uint32_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::float32:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(int8, float32_t, int8_t)
+                KERNEL_CASE(int16, float32_t, int16_t)
+                KERNEL_CASE(uint8, float32_t, uint8_t)
+                KERNEL_CASE(uint16, float32_t, uint16_t)
+        KERNEL_SWITCH_END
+
+        case DcpDataType::float64:
+            KERNEL_SWITCH_START //
+                KERNEL_CASE(int8, float64_t, int8_t)
+                KERNEL_CASE(int16, float64_t, int16_t)
+                KERNEL_CASE(int32, float64_t, int32_t)
+                KERNEL_CASE(uint8, float64_t, uint8_t)
+                KERNEL_CASE(uint16, float64_t, uint16_t)
+                KERNEL_CASE(uint32, float64_t, uint32_t)
+                KERNEL_CASE(float32, float64_t, float32_t)
+        KERNEL_SWITCH_END
+
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+/**
+ * Number of DcpDataTypes which can be assigned to inputs, outputs and parameters (uint8 to binary).
+ */
+#define NUM_VALUE_DATA_TYPES 12
+
+/**
+ * Table of the conversion kernels of all (target, source) data type pairs.
+ * Each kernel is selected once, preferring a vectorized variant supported by the running cpu.
+ */
+struct ConversionKernelTable {
+    ConversionKernel kernels[NUM_VALUE_DATA_TYPES + 1][NUM_VALUE_DATA_TYPES];
+
+    ConversionKernelTable() {
+        for (uint8_t target = 0; target <= NUM_VALUE_DATA_TYPES; target++) {
+            for (uint8_t source = 0; source < NUM_VALUE_DATA_TYPES; source++) {
+                kernels[target][source] = nullptr;
+                if (target == NUM_VALUE_DATA_TYPES) {
+                    continue;
+                }
+#ifdef DCPLIB_X86_KERNELS
+                kernels[target][source] = getSimdConversionKernel((DcpDataType) target, (DcpDataType) source);
+#endif
+                if (kernels[target][source] == nullptr) {
+                    kernels[target][source] = getScalarConversionKernel((DcpDataType) target, (DcpDataType) source);
+                }
+            }
+        }
+    }
+};
+
+/**
+ * Returns the conversion kernels for targetDataType, indexed by the source data type.
+ * Entries of not allowed conversions are nullptr.
+ */
+static const ConversionKernel *getConversionKernels(DcpDataType targetDataType) {
+    static const ConversionKernelTable table;
+    uint8_t target = (uint8_t) targetDataType;
+    return table.kernels[target < NUM_VALUE_DATA_TYPES ? target : NUM_VALUE_DATA_TYPES];
+}
+
+/**
+ * Returns the kernel converting fixed size values of sourceDataType to targetDataType.
+ * @return the kernel, or nullptr if the types are variable sized or the conversion is not allowed
+ */
+static ConversionKernel getConversionKernel(DcpDataType targetDataType, DcpDataType sourceDataType) {
+    uint8_t source = (uint8_t) sourceDataType;
+    return source < NUM_VALUE_DATA_TYPES ? getConversionKernels(targetDataType)[source] : nullptr;
+}
+
+#endif //DCPLIB_CONVERSIONKERNELS_HPP
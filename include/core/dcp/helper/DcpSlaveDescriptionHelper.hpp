@@ -310,6 +310,10 @@ namespace slavedescription {
                 return slaveDescription.TransportProtocols.USB.get() != nullptr;
             case DcpTransportProtocol::TCP_IPv4:
                 return slaveDescription.TransportProtocols.TCP_IPv4.get() != nullptr;
+            case DcpTransportProtocol::SHARED_MEMORY:
+                return slaveDescription.TransportProtocols.SharedMemory.get() != nullptr;
+            case DcpTransportProtocol::UNIX_DOMAIN:
+                return slaveDescription.TransportProtocols.UnixDomain;
         }
         throw std::runtime_error(std::string("Invalid DcpTransportProtocol encountered: ") + std::to_string(static_cast<uint8_t>(transportProtocol)));
     }
@@ -375,6 +379,26 @@ namespace slavedescription {
     }
 
 
+    inline const bool isSharedMemoryPortSupportedForInputOutput(const SlaveDescription_t &slaveDescription,
+                                                                uint16_t port) {
+        if (slaveDescription.TransportProtocols.SharedMemory.get() != nullptr) {
+            return isEthernetPortSupportedForInputOutput(slaveDescription.TransportProtocols.SharedMemory,
+                                                         slaveDescription.TransportProtocols.SharedMemory->DAT_input_output,
+                                                         slaveDescription, port);
+        }
+        return false;
+    }
+
+
+    inline const std::string supportedSharedMemoryPorts(const SlaveDescription_t &slaveDescription) {
+        if (slaveDescription.TransportProtocols.SharedMemory.get() != nullptr) {
+            return supportedEthernetPorts(slaveDescription.TransportProtocols.SharedMemory,
+                                          slaveDescription.TransportProtocols.SharedMemory->DAT_input_output,
+                                          slaveDescription);
+        }
+        return "";
+    }
+
     inline const std::string supportedUdpPorts(const SlaveDescription_t &slaveDescription) {
         if (slaveDescription.TransportProtocols.UDP_IPv4.get() != nullptr) {
             return supportedEthernetPorts(slaveDescription.TransportProtocols.UDP_IPv4,
@@ -413,6 +437,17 @@ namespace slavedescription {
     }
 
 
+    inline const bool isSharedMemoryPortSupportedForParameter(const SlaveDescription_t &slaveDescription,
+                                                              uint16_t port) {
+        if (slaveDescription.TransportProtocols.SharedMemory.get() != nullptr) {
+            return isEthernetPortSupportedForInputOutput(slaveDescription.TransportProtocols.SharedMemory,
+                                                         slaveDescription.TransportProtocols.SharedMemory->DAT_parameter,
+                                                         slaveDescription, port);
+        }
+        return false;
+    }
+
+
     inline const std::string supportedUdpPortsParameter(const SlaveDescription_t &slaveDescription) {
         if (slaveDescription.TransportProtocols.UDP_IPv4.get() != nullptr) {
             return supportedEthernetPorts(slaveDescription.TransportProtocols.UDP_IPv4,
@@ -431,6 +466,15 @@ namespace slavedescription {
         return "";
     }
 
+    inline const std::string supportedSharedMemoryPortsParameter(const SlaveDescription_t &slaveDescription) {
+        if (slaveDescription.TransportProtocols.SharedMemory.get() != nullptr) {
+            return supportedEthernetPorts(slaveDescription.TransportProtocols.SharedMemory,
+                                          slaveDescription.TransportProtocols.SharedMemory->DAT_parameter,
+                                          slaveDescription);
+        }
+        return "";
+    }
+
     inline const bool logCategoryExists(const SlaveDescription_t &slaveDescription, uint8_t logCategory) {
         if (slaveDescription.Log.get() != nullptr) {
             for (const auto &logCat : slaveDescription.Log->categories) {
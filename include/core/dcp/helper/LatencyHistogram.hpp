@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_LATENCYHISTOGRAM_HPP
+#define DCPLIB_LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace internal {
+    /**
+     * Log-linear bucketing of nanosecond values: every power of two is split into
+     * 16 linear sub buckets, which bounds the relative error of a bucket to 1/16.
+     */
+    struct LatencyBuckets {
+        enum : uint32_t {
+            SUB_BUCKET_BITS = 4,
+            SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+            //values from 2^40 ns (~18 min) on are counted in the last bucket
+            MAX_EXPONENT = 40,
+            COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS,
+        };
+
+        static uint32_t highestBit(uint64_t value) {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(value);
+#else
+            uint32_t bit = 0;
+            while (value >>= 1) {
+                bit++;
+            }
+            return bit;
+#endif
+        }
+
+        static uint32_t indexOf(uint64_t value) {
+            if (value < SUB_BUCKETS) {
+                return (uint32_t) value;
+            }
+            uint32_t exponent = highestBit(value);
+            if (exponent >= MAX_EXPONENT) {
+                return COUNT - 1;
+            }
+            uint32_t sub = (uint32_t) (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+            return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+        }
+
+        /**
+         * @return Smallest value which is counted in bucket index
+         */
+        static uint64_t lowerBound(uint32_t index) {
+            if (index < SUB_BUCKETS) {
+                return index;
+            }
+            uint32_t exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+            uint64_t sub = index % SUB_BUCKETS;
+            return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+        }
+    };
+}
+
+/**
+ * Copy of a LatencyHistogram at one point in time. All values in nanoseconds.
+ */
+struct LatencySnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    double getMean() const {
+        return count == 0 ? 0 : (double) sum / (double) count;
+    }
+
+    /**
+     * @param percentile Percentile in [0, 100]
+     * @return Lower bound of the bucket which contains the given percentile, 0 for an empty snapshot
+     */
+    uint64_t getValueAtPercentile(double percentile) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t) (percentile / 100.0 * (double) count);
+        if (rank >= count) {
+            rank = count - 1;
+        }
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < buckets.size(); i++) {
+            seen += buckets[i];
+            if (seen > rank) {
+                return internal::LatencyBuckets::lowerBound(i);
+            }
+        }
+        return max;
+    }
+};
+
+/**
+ * Histogram of latencies in nanoseconds with a bounded relative error.
+ * Recording is wait-free and may happen from any thread, also while a snapshot is taken.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram() : sum(0), max(0) {
+        for (std::atomic<uint64_t> &bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(int64_t nanoseconds) {
+        uint64_t value = nanoseconds > 0 ? (uint64_t) nanoseconds : 0;
+        buckets[internal::LatencyBuckets::indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t currentMax = max.load(std::memory_order_relaxed);
+        while (value > currentMax && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Copies the current state. Records which happen during the copy may be partially included.
+     */
+    LatencySnapshot snapshot() const {
+        LatencySnapshot snapshot;
+        snapshot.buckets.resize(internal::LatencyBuckets::COUNT);
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < internal::LatencyBuckets::COUNT; i++) {
+            snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+            total += snapshot.buckets[i];
+        }
+        snapshot.count = total;
+        snapshot.sum = sum.load(std::memory_order_relaxed);
+        snapshot.max = max.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    void reset() {
+        for (std::atomic<uint64_t> &bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        sum.store(0, std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> buckets[internal::LatencyBuckets::COUNT];
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+#endif //DCPLIB_LATENCYHISTOGRAM_HPP
@@ -12,8 +12,11 @@
 
 #include <typeinfo>
 #include <iomanip>
+#include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <memory>
+#include <cstdlib>
 
 #include <dcp/model/constant/DcpDataType.hpp>
 #include <dcp/model/constant/DcpPduType.hpp>
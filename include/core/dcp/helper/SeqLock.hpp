@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_SEQLOCK_HPP
+#define DCPLIB_SEQLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Sequence lock for one writer and any number of readers. Neither side ever waits.
+ * A reader copies the protected data between beginRead and retryRead and may only use
+ * the copy if retryRead returns false, otherwise it keeps its previous copy or tries again later.
+ */
+class SeqLock {
+public:
+    SeqLock() : sequence(0) {}
+
+    void beginWrite() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite() {
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @return the current sequence, odd while a write is in progress
+     */
+    uint32_t beginRead() const {
+        return sequence.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return True if a write was in progress when beginRead returned start or happened since,
+     * i.e. the copy may be torn
+     */
+    bool retryRead(uint32_t start) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return (start & 1) || sequence.load(std::memory_order_relaxed) != start;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+};
+
+#endif //DCPLIB_SEQLOCK_HPP
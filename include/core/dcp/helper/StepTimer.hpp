@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_STEPTIMER_HPP
+#define DCPLIB_STEPTIMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#endif
+
+/**
+ * Waits for absolute deadlines on the monotonic steady_clock.
+ * The timer sleeps until spinWindow before the deadline and busy waits for the rest,
+ * which trades CPU time for a lower wakeup jitter. On Linux the sleep is done with
+ * clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME).
+ * Derived classes may replace waitUntil by another strategy.
+ */
+class StepTimer {
+public:
+    typedef std::chrono::steady_clock clock;
+
+    explicit StepTimer(std::chrono::nanoseconds spinWindow = std::chrono::nanoseconds(0)) :
+            spinWindow(spinWindow.count()), lastLateness(0), maxLateness(0) {}
+
+    virtual ~StepTimer() {}
+
+    /**
+     * @param spinWindow Time before a deadline which is busy waited instead of slept. 0 disables spinning.
+     */
+    void setSpinWindow(std::chrono::nanoseconds spinWindow) {
+        this->spinWindow = spinWindow.count();
+    }
+
+    /**
+     * Blocks until deadline is reached.
+     * @return Lateness of the wakeup, i.e. the time between deadline and return. If deadline was already
+     * over, this is how late the call was. Recorded in both cases.
+     */
+    virtual std::chrono::nanoseconds waitUntil(clock::time_point deadline) {
+        using namespace std::chrono;
+        clock::time_point sleepUntil = deadline - nanoseconds(spinWindow.load());
+        if (clock::now() < sleepUntil) {
+            sleep(sleepUntil);
+        }
+        while (clock::now() < deadline) {
+            //spin
+        }
+        nanoseconds lateness = duration_cast<nanoseconds>(clock::now() - deadline);
+        lastLateness = lateness.count();
+        if (lateness.count() > maxLateness) {
+            maxLateness = lateness.count();
+        }
+        return lateness;
+    }
+
+    /**
+     * @return Lateness of the last wakeup
+     */
+    std::chrono::nanoseconds getLastLateness() const {
+        return std::chrono::nanoseconds(lastLateness.load());
+    }
+
+    /**
+     * @return Maximum lateness of all wakeups
+     */
+    std::chrono::nanoseconds getMaxLateness() const {
+        return std::chrono::nanoseconds(maxLateness.load());
+    }
+
+    /**
+     * Translates a wall clock time, e.g. the start time of STC_run, to the steady clock.
+     */
+    static clock::time_point fromSystemTime(std::chrono::system_clock::time_point time) {
+        return clock::now() + std::chrono::duration_cast<clock::duration>(time - std::chrono::system_clock::now());
+    }
+
+    /**
+     * Translates a steady clock time to wall clock time, e.g. for log messages.
+     */
+    static std::chrono::system_clock::time_point toSystemTime(clock::time_point time) {
+        return std::chrono::system_clock::now() +
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(time - clock::now());
+    }
+
+protected:
+    std::atomic<int64_t> spinWindow;
+    std::atomic<int64_t> lastLateness;
+    std::atomic<int64_t> maxLateness;
+
+    static void sleep(clock::time_point until) {
+#if defined(__linux__)
+        //libstdc++ and libc++ implement steady_clock with CLOCK_MONOTONIC
+        using namespace std::chrono;
+        int64_t ns = duration_cast<nanoseconds>(until.time_since_epoch()).count();
+        timespec ts;
+        ts.tv_sec = ns / 1000000000;
+        ts.tv_nsec = ns % 1000000000;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+#else
+        std::this_thread::sleep_until(until);
+#endif
+    }
+};
+
+#endif //DCPLIB_STEPTIMER_HPP
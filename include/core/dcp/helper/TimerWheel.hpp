@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_TIMERWHEEL_HPP
+#define DCPLIB_TIMERWHEEL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Hashed timer wheel which runs periodic timers on one thread.
+ * Timers are identified by an id below maxTimers. Setting and cancelling a timer is O(1):
+ * a timer is appended to the slot of its next expiry, a cancelled timer is only marked and
+ * dropped when its slot is visited. Periods longer than one revolution of the wheel are
+ * counted in rounds. The thread sleeps until the next non empty slot and is started with
+ * the first timer.
+ * Callbacks are executed on the wheel thread without holding the lock of the wheel.
+ */
+class TimerWheel {
+public:
+    /**
+     * @param maxTimers Number of timer ids
+     * @param tick Resolution of the wheel
+     * @param numSlots Number of slots, rounded up to the next power of two
+     */
+    explicit TimerWheel(size_t maxTimers, std::chrono::microseconds tick = std::chrono::milliseconds(1),
+                        size_t numSlots = 1024) : timers(maxTimers), tick(tick), currentTick(0), activeTimers(0),
+                                                  started(false), wakeup(false), shutdown(false) {
+        size_t size = 2;
+        while (size < numSlots) {
+            size *= 2;
+        }
+        wheel.resize(size);
+        mask = size - 1;
+    }
+
+    ~TimerWheel() {
+        stop();
+    }
+
+    TimerWheel(const TimerWheel &) = delete;
+
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    /**
+     * Starts or replaces the periodic timer id. The callback is called immediately and then every period.
+     */
+    void setTimer(size_t id, std::chrono::microseconds period, std::function<void()> callback) {
+        std::lock_guard<std::mutex> lock(mtx);
+        Timer &timer = timers[id];
+        if (!timer.active) {
+            activeTimers++;
+        }
+        timer.callback = std::move(callback);
+        timer.period = period.count() / tick.count() > 0 ? (uint64_t) (period.count() / tick.count()) : 1;
+        timer.generation++;
+        timer.active = true;
+        if (!started) {
+            origin = std::chrono::steady_clock::now();
+            thread = std::thread(&TimerWheel::run, this);
+            started = true;
+        }
+        uint64_t now = nowTick();
+        insert(id, now > currentTick ? now : currentTick);
+        wakeup = true;
+        cv.notify_one();
+    }
+
+    /**
+     * Stops the timer id. If its callback is running at the moment, waits until it returned,
+     * unless called from a callback on the wheel thread. No callback of id runs after the return.
+     * @return False if the timer was not active
+     */
+    bool cancelTimer(size_t id) {
+        std::unique_lock<std::mutex> lock(mtx);
+        Timer &timer = timers[id];
+        if (!timer.active) {
+            return false;
+        }
+        timer.active = false;
+        timer.generation++;
+        timer.callback = nullptr;
+        activeTimers--;
+        if (std::this_thread::get_id() != thread.get_id()) {
+            idle.wait(lock, [&timer] { return !timer.running; });
+        }
+        return true;
+    }
+
+    /**
+     * Cancels all timers and stops the wheel thread. Does nothing if the wheel is not running,
+     * so it may be called repeatedly. A later setTimer starts the wheel again.
+     */
+    void stop() {
+        std::lock_guard<std::mutex> stopLock(mtxStop);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!started) {
+                return;
+            }
+            shutdown = true;
+            cv.notify_one();
+        }
+        if (thread.joinable()) {
+            thread.join();
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        for (Timer &timer : timers) {
+            timer.active = false;
+            timer.generation++;
+            timer.callback = nullptr;
+        }
+        for (std::vector<Entry> &slot : wheel) {
+            slot.clear();
+        }
+        activeTimers = 0;
+        currentTick = 0;
+        started = false;
+        shutdown = false;
+        wakeup = false;
+    }
+
+private:
+    struct Timer {
+        std::function<void()> callback;
+        uint64_t period = 1;
+        uint32_t generation = 0;
+        bool active = false;
+        //the callback was taken for execution by the wheel thread and has not returned yet
+        bool running = false;
+    };
+
+    struct Entry {
+        size_t id;
+        uint32_t generation;
+        uint64_t rounds;
+    };
+
+    std::vector<Timer> timers;
+    std::vector<std::vector<Entry>> wheel;
+    size_t mask;
+    std::chrono::microseconds tick;
+    std::chrono::steady_clock::time_point origin;
+    //next tick to process
+    uint64_t currentTick;
+    size_t activeTimers;
+
+    std::mutex mtx;
+    //serializes stop, which joins the thread outside of mtx
+    std::mutex mtxStop;
+    std::condition_variable cv;
+    //signalled when callbacks taken by the wheel thread returned
+    std::condition_variable idle;
+    std::thread thread;
+    bool started;
+    bool wakeup;
+    bool shutdown;
+
+    uint64_t nowTick() const {
+        return (uint64_t) (std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - origin).count() / tick.count());
+    }
+
+    void insert(size_t id, uint64_t dueTick) {
+        uint64_t delay = dueTick - currentTick;
+        wheel[dueTick & mask].push_back({id, timers[id].generation, delay / wheel.size()});
+    }
+
+    void run() {
+        std::vector<std::function<void()>> due;
+        std::vector<size_t> dueIds;
+        std::vector<Entry> rescheduled;
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!shutdown) {
+            if (activeTimers == 0) {
+                cv.wait(lock, [this] { return shutdown || activeTimers > 0; });
+                continue;
+            }
+            uint64_t now = nowTick();
+            while (currentTick <= now) {
+                std::vector<Entry> &slot = wheel[currentTick & mask];
+                size_t kept = 0;
+                for (size_t i = 0; i < slot.size(); i++) {
+                    Entry entry = slot[i];
+                    Timer &timer = timers[entry.id];
+                    if (!timer.active || timer.generation != entry.generation) {
+                        continue;
+                    }
+                    if (entry.rounds > 0) {
+                        entry.rounds--;
+                        slot[kept++] = entry;
+                        continue;
+                    }
+                    due.push_back(timer.callback);
+                    dueIds.push_back(entry.id);
+                    timer.running = true;
+                    entry.rounds = (timer.period - 1) / wheel.size();
+                    rescheduled.push_back(entry);
+                }
+                slot.resize(kept);
+                for (const Entry &entry : rescheduled) {
+                    wheel[(currentTick + timers[entry.id].period) & mask].push_back(entry);
+                }
+                rescheduled.clear();
+                currentTick++;
+                if (!due.empty()) {
+                    lock.unlock();
+                    for (std::function<void()> &callback : due) {
+                        callback();
+                    }
+                    due.clear();
+                    lock.lock();
+                    for (size_t id : dueIds) {
+                        timers[id].running = false;
+                    }
+                    dueIds.clear();
+                    idle.notify_all();
+                    if (shutdown) {
+                        return;
+                    }
+                }
+            }
+            uint64_t next = currentTick;
+            while (next < currentTick + wheel.size() && wheel[next & mask].empty()) {
+                next++;
+            }
+            wakeup = false;
+            cv.wait_until(lock, origin + tick * next, [this] { return shutdown || wakeup; });
+        }
+    }
+};
+
+#endif //DCPLIB_TIMERWHEEL_HPP
@@ -13,9 +13,11 @@
 #include <cstdint>
 #include <map>
 #include <list>
+#include <mutex>
 
 #include <dcp/logic/DcpManager.hpp>
 #include <dcp/driver/DcpDriver.hpp>
+#include <dcp/logic/CallbackExecutor.hpp>
 #if defined(DEBUG) || defined(LOGGING)
 #include <dcp/logic/Logable.hpp>
 #include <dcp/helper/LogHelper.hpp>
@@ -67,6 +69,14 @@ public:
 
     virtual DcpManager getDcpManager() = 0;
 
+    /**
+     * Worker pool which executes all listeners registered as ASYNC.
+     * Can be configured until the first ASYNC listener is called.
+     */
+    CallbackExecutor &getCallbackExecutor() {
+        return callbackExecutor;
+    }
+
 protected:
     /**
      * DCP Driver instance
@@ -99,6 +109,10 @@ protected:
      * last seq. id which was received
      */
     std::map<uint16_t, uint16_t> parameterSegNumsIn;
+    /**
+     * guards dataSegNumsIn and parameterSegNumsIn, DAT PDUs may be received on several threads
+     */
+    std::mutex segNumsInMutex;
 
     std::vector<std::function<void(const LogEntry &)>> logListeners;
     bool generateLogString;
@@ -106,6 +120,8 @@ protected:
     uint8_t dcpId;
     uint8_t masterId;
 
+    CallbackExecutor callbackExecutor;
+
 protected:
     AbstractDcpManager() {
 #if defined(DEBUG) || defined(LOGGING)
@@ -141,6 +157,7 @@ protected:
     
     uint16_t checkSeqIdInOut(const uint16_t dataId,
                              const uint16_t seqId) {
+        std::lock_guard<std::mutex> lock(segNumsInMutex);
         if (dataSegNumsIn.count(dataId)){
             uint16_t old = dataSegNumsIn[dataId];
             if (seqId > old) {
@@ -156,6 +173,7 @@ protected:
 
     uint16_t checkSeqIdParam(const uint16_t parameterId,
                              const uint16_t seqId) {
+        std::lock_guard<std::mutex> lock(segNumsInMutex);
         if (parameterSegNumsIn.count(parameterId)){
             uint16_t old = parameterSegNumsIn[parameterId];
             if (seqId > old) {
@@ -15,6 +15,15 @@
 #include <vector>
 #include <set>
 #include <iterator>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/un.h>
+#endif
 
 #include <dcp/model/DcpTypes.hpp>
 #include <dcp/model/pdu/DcpPdu.hpp>
@@ -43,9 +52,12 @@
 #include <dcp/model/pdu/DcpPduStcRegister.hpp>
 #include <dcp/model/pdu/DcpPduStcRun.hpp>
 #include <dcp/model/MultiDimValue.hpp>
+#include <dcp/model/ValueStore.hpp>
+#include <dcp/model/ValueHandle.hpp>
 
 #include <dcp/helper/Helper.hpp>
 #include <dcp/helper/DcpSlaveDescriptionHelper.hpp>
+#include <dcp/helper/SeqLock.hpp>
 
 #include <dcp/logic/AbstractDcpManager.hpp>
 #include <dcp/xml/DcpSlaveDescriptionElements.hpp>
@@ -64,6 +76,20 @@ struct Payload {
     size_t size;
 };
 
+namespace internal {
+    /**
+     * Longest socket path of the transport protocol UNIX_DOMAIN, without the terminating zero.
+     * 0 on platforms without unix domain sockets.
+     */
+    inline size_t maxUnixDomainPathLength() {
+#if defined(__unix__) || defined(__APPLE__)
+        return sizeof(sockaddr_un::sun_path) - 1;
+#else
+        return 0;
+#endif
+    }
+}
+
 
 /**
  * Basic Logic for a DCP slave
@@ -74,14 +100,7 @@ class AbstractDcpManagerSlave : public AbstractDcpManager {
 public:
 
 
-    ~AbstractDcpManagerSlave() {
-        for (auto const &entry : values) {
-            delete entry.second;
-        }
-        for (auto const &entry : updatedStructure) {
-            delete entry.second;
-        }
-    }
+    ~AbstractDcpManagerSlave() {}
 
     void receive(DcpPdu &msg) override {
 
@@ -121,6 +140,11 @@ public:
                 for (auto &entry : stepsToDataId) {
                     outputCounter.push_back(std::make_tuple(entry.second, entry.first, entry.first));
                 }
+                {
+                    std::lock_guard<std::mutex> lock(inputWriteMutex);
+                    std::atomic_store(&inputDecodePlans, buildInputDecodePlans());
+                }
+                buildOutputEncodePlans();
                 driver.configure();
                 configure();
                 break;
@@ -232,6 +256,7 @@ public:
                 inputAssignment[inputConfig.getDataId()][inputConfig.getPos()] = std::make_pair(
                         inputConfig.getTargetVr(),
                         inputConfig.getSourceDataType());
+                invalidateInputDecodePlans();
                 std::shared_ptr<uint32_t> maxConsecMissedPdus = slavedescription::getVariable(slaveDescription,
                         inputConfig.getTargetVr())->maxConsecMissedPdus;
                 if(maxConsecMissedPdus != nullptr){
@@ -294,26 +319,48 @@ public:
             }
             case DcpPduType::DAT_input_output: {
                 DcpPduDatInputOutput &data = static_cast<DcpPduDatInputOutput &>(msg);
-                int offset = 0;
-                std::map<uint16_t, std::pair<uint64_t, DcpDataType>> vrsToReceive =
-                        inputAssignment[data.getDataId()];
-                for (uint16_t i = 0; i < vrsToReceive.size(); i++) {
-                    std::pair<uint64_t, DcpDataType> p = vrsToReceive[i];
-                    uint64_t valueReference = p.first;
-                    DcpDataType sourceDataType = p.second;
-                    try {
-                        offset += values[valueReference]->update(data.getPayload(), offset, sourceDataType);
-                    }
-                    catch (std::range_error) {
+                std::shared_ptr<const InputDecodePlans> plans = getInputDecodePlans();
+                if (data.getDataId() >= plans->plans.size()) {
+                    break;
+                }
+                const InputDecodePlan &plan = plans->plans[data.getDataId()];
+                const uint8_t *payload = data.getPayload();
+                size_t offset = 0;
+                //data ids are decoded concurrently if the driver receives on several threads, and
+                //PDUs of different data ids may write the same values. Uncontended with one thread
+                std::unique_lock<std::mutex> writeLock(inputWriteMutex);
+                if (plans->buffered) {
+                    inputSeqLock.beginWrite();
+                    inputWrites++;
+                }
+                for (const InputDecodeStep &step : plan.steps) {
+                    if (step.convert != nullptr) {
+                        step.convert(step.destination, payload + offset, step.count);
+                        offset += step.sourceSize;
+                    } else {
+                        try {
+                            offset += step.value->update(payload, offset, step.sourceDataType);
+                        }
+                        catch (std::range_error) {
 #ifdef DEBUG
-                        Log(INVALID_PAYLOAD, valueReference);
+                            Log(INVALID_PAYLOAD, step.valueReference);
 #endif
+                        }
                     }
 #ifdef DEBUG
-                    Log(ASSIGNED_INPUT, valueReference, sourceDataType,
-                        slavedescription::getDataType(slaveDescription, valueReference));
+                    Log(ASSIGNED_INPUT, step.valueReference, step.sourceDataType,
+                        slavedescription::getDataType(slaveDescription, step.valueReference));
 #endif
-                    notifyInputOutputUpdateListener(valueReference);
+                    if (plans->buffered) {
+                        plans->shadowVersions[step.shadow].store(inputWrites, std::memory_order_relaxed);
+                    }
+                }
+                if (plans->buffered) {
+                    inputSeqLock.endWrite();
+                }
+                writeLock.unlock();
+                for (const InputDecodeStep &step : plan.steps) {
+                    notifyInputOutputUpdateListener(step.valueReference);
                 }
                 break;
             }
@@ -583,11 +630,102 @@ public:
         return values[vr]->getValue<T>();
     }
 
+    /**
+     * Enable double buffered inputs. Received DAT_input_output PDUs are then decoded into a back
+     * buffer, and the inputs seen by the step callbacks are updated only at the start of each step,
+     * from the last completely received PDUs. Receiving never waits for a step and vice versa.
+     * Has to be set before STC_configure.
+     */
+    void setBufferedInputs(bool bufferedInputs) {
+        this->bufferedInputs = bufferedInputs;
+        invalidateInputDecodePlans();
+    }
+
+    /**
+     * @return Number of steps which kept the previous input snapshot, because every attempt
+     * to copy the buffered inputs overlapped a received PDU
+     */
+    uint64_t getStaleInputSnapshots() const {
+        return staleInputSnapshots.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Resolve a handle to an input. The handle stays valid for the lifetime of the manager,
+     * also when structural parameters change the dimensions of the input.
+     * In debug builds T is checked against the slave description.
+     * @tparam T Element type of the input. E. g. uint16_t for uint16.
+     * @param vr Value reference of the input
+     * @return Handle to the value of the corresponding input.
+     */
+    template<typename T>
+    ValueHandle<T> getInputHandle(uint64_t vr) {
+#if defined(DEBUG)
+        checkHandleType<T>(vr, slavedescription::inputExists(slaveDescription, vr), "an input");
+#endif
+        return resolveHandle<T>(vr);
+    }
+
+    /**
+     * Resolve a handle to an output. See getInputHandle.
+     * @tparam T Element type of the output. E. g. uint16_t for uint16.
+     * @param vr Value reference of the output
+     * @return Handle to the value of the corresponding output.
+     */
+    template<typename T>
+    ValueHandle<T> getOutputHandle(uint64_t vr) {
+#if defined(DEBUG)
+        checkHandleType<T>(vr, slavedescription::outputExists(slaveDescription, vr), "an output");
+#endif
+        return resolveHandle<T>(vr);
+    }
+
+    /**
+     * Resolve a handle to a parameter or structural parameter. See getInputHandle.
+     * @tparam T Element type of the parameter. E. g. uint16_t for uint16.
+     * @param vr Value reference of the parameter
+     * @return Handle to the value of the corresponding parameter.
+     */
+    template<typename T>
+    ValueHandle<T> getParameterHandle(uint64_t vr) {
+#if defined(DEBUG)
+        checkHandleType<T>(vr, slavedescription::parameterExists(slaveDescription, vr) ||
+                               slavedescription::structuralParameterExists(slaveDescription, vr), "a parameter");
+#endif
+        return resolveHandle<T>(vr);
+    }
+
 
 protected:
 
     virtual void stopRunning() = 0;
 
+    template<typename T>
+    ValueHandle<T> resolveHandle(uint64_t vr) {
+        MultiDimValue *value = values[vr];
+        if (value == nullptr) {
+            throw std::invalid_argument("No value exists for value reference " + std::to_string(vr));
+        }
+        return ValueHandle<T>(value);
+    }
+
+    template<typename T>
+    void checkHandleType(uint64_t vr, bool exists, const std::string &kind) {
+        if (!exists) {
+            throw std::invalid_argument("Value reference " + std::to_string(vr) + " is not " + kind);
+        }
+        DcpDataType dataType = slavedescription::getDataType(slaveDescription, vr);
+        bool matches;
+        if (dataType == DcpDataType::string || dataType == DcpDataType::binary) {
+            matches = sizeof(T) == 1;
+        } else {
+            matches = std::is_arithmetic<T>::value && getFixedSizeDcpDataType<T>() == dataType;
+        }
+        if (!matches) {
+            throw std::invalid_argument("Value reference " + std::to_string(vr) + " is of type " +
+                                        to_string(dataType) + ", not " + type_name<T>());
+        }
+    }
+
     const SlaveDescription_t slaveDescription;
 
     std::map<DcpState, std::map<DcpPduType, bool>> stateChangePossible;
@@ -621,7 +759,7 @@ protected:
     uint8_t *logRspBuffer = new uint8_t[bufferSize];
 #endif
     /*Data Handling*/
-    std::map<valueReference_t, MultiDimValue *> values;
+    ValueStore values;
 
     std::set<dataId_t> sourceNetworkConfigured;
     std::set<dataId_t> targetNetworkConfigured;
@@ -632,6 +770,29 @@ protected:
     std::map<dataId_t, std::map<pos_t, valueReference_t>> outputAssignment;
     std::map<dataId_t, std::vector<pos_t>> configuredOutPos;
 
+    /**
+     * One range of a DAT_input_output payload, resolved from outputAssignment.
+     * Fixed size values are copied from source, adjacent ones are merged into one range.
+     * Variable sized values (string, binary) have no source and are serialized through value.
+     */
+    struct OutputEncodeStep {
+        const uint8_t *source;
+        size_t size;
+        MultiDimValue *value;
+    };
+    struct OutputEncodePlan {
+        DcpPduDatInputOutput *pdu = nullptr;
+        std::vector<OutputEncodeStep> steps;
+    };
+    //encode plan for each data id, indexed by data id
+    std::vector<OutputEncodePlan> outputEncodePlans;
+    bool outputEncodePlansValid = false;
+    //PDUs collected by sendOutputs, kept to avoid an allocation per step
+    std::vector<DcpPdu *> pdusToSend;
+    //sendOutputs is entered from the receive thread (STC_send_outputs) and the step thread,
+    //guards pdusToSend and the lazy build of the encode plans
+    std::mutex sendOutputsMutex;
+
     std::vector<dataId_t> runningScope;
     std::vector<dataId_t> initializationScope;
 
@@ -644,6 +805,67 @@ protected:
     std::map<dataId_t, std::map<pos_t, std::pair<valueReference_t, DcpDataType>>> inputAssignment;
     std::map<dataId_t, std::vector<pos_t>> configuredInPos;
 
+    /**
+     * One assignment of a DAT_input_output payload to an input, resolved from inputAssignment.
+     * Fixed size values are converted by convert, which reads sourceSize bytes of payload.
+     * Variable sized values (string, binary) have no kernel and are updated through value.
+     */
+    struct InputDecodeStep {
+        uint8_t *destination;
+        ConversionKernel convert;
+        size_t count;
+        size_t sourceSize;
+        DcpDataType sourceDataType;
+        MultiDimValue *value;
+        valueReference_t valueReference;
+        //index in InputDecodePlans::shadows if inputs are buffered
+        size_t shadow;
+    };
+    /**
+     * Decode steps of one data id. The payload has fixedPayloadSize bytes of fixed size values,
+     * plus the string and binary values, whose size is only known from their length prefix.
+     */
+    struct InputDecodePlan {
+        std::vector<InputDecodeStep> steps;
+        size_t fixedPayloadSize = 0;
+        //for each string or binary value, the fixed size payload bytes since the previous one
+        std::vector<size_t> variableFieldGaps;
+    };
+    /**
+     * Decode plans of all data ids with the shadows they write to. A published instance is never
+     * changed, a rebuild publishes a new one. Receiving threads keep the one they started with alive.
+     */
+    struct InputDecodePlans {
+        //indexed by data id
+        std::vector<InputDecodePlan> plans;
+        //double buffered inputs: the plans write into shadows, which are copied to the inputs per step
+        bool buffered = false;
+        std::vector<uint8_t> shadowStorage;
+        std::deque<MultiDimValue> shadows;
+        //pairs of input and its shadow
+        std::vector<std::pair<MultiDimValue *, MultiDimValue *>> snapshotCopies;
+        //number of the last PDU which wrote a shadow. Only received shadows are copied, so values set by the
+        //application before the first PDU are kept
+        std::unique_ptr<std::atomic<uint64_t>[]> shadowVersions;
+    };
+    //accessed with std::atomic_load/std::atomic_store only, nullptr if it has to be rebuilt
+    std::shared_ptr<const InputDecodePlans> inputDecodePlans;
+    //guards building the decode plans and decoding DAT_input_output PDUs, the writer side of inputSeqLock
+    std::mutex inputWriteMutex;
+
+    bool bufferedInputs = false;
+    SeqLock inputSeqLock;
+    //plans the snapshot versions below belong to
+    std::shared_ptr<const InputDecodePlans> inputSnapshotPlans;
+    std::vector<uint64_t> inputSnapshotVersions;
+    std::vector<uint64_t> inputSnapshotReadVersions;
+    //shadows copied under inputSeqLock, applied to the inputs only if the copy is consistent
+    std::vector<uint8_t> inputSnapshotStaging;
+    std::vector<size_t> inputSnapshotChanged;
+    static const int maxInputSnapshotAttempts = 4;
+    std::atomic<uint64_t> staleInputSnapshots{0};
+    uint64_t inputWrites = 0;
+
     std::map<dataId_t, uint16_t> maxConsecMissedPduData;
 
     //Parameter
@@ -655,7 +877,8 @@ protected:
 
     //which sttructual parameter (valueReference) change which inputs/outputs/parameters (valueReference)
     std::map<valueReference_t, std::vector<std::pair<valueReference_t, size_t>>> structualDependencies;
-    std::map<valueReference_t, MultiDimValue *> updatedStructure;
+    //new dimensions of parameters, applied on their next update
+    std::map<valueReference_t, std::vector<size_t>> updatedStructure;
 
 
 #if defined(DEBUG) || defined(LOGGING)
@@ -836,7 +1059,7 @@ protected:
                 }
                 std::vector<size_t> dimensions;
                 dimensions.push_back(1);
-                values[valueReference] = new MultiDimValue(dataType, baseSize, dimensions);
+                values.create(valueReference, dataType, baseSize, dimensions);
                 switch (dataType) {
                     case DcpDataType::uint8: {
                         if (var.StructuralParameter.get()->Uint8.get()->start.get() != nullptr) {
@@ -948,7 +1171,7 @@ protected:
                     dimensions.push_back(1);
                 }
 
-                values[valueReference] = new MultiDimValue(dataType, baseSize, dimensions);
+                values.create(valueReference, dataType, baseSize, dimensions);
 
                 switch (dataType) {
                     case DcpDataType::int8: {
@@ -1121,7 +1344,7 @@ protected:
                 } else {
                     dimensions.push_back(1);
                 }
-                values[valueReference] = new MultiDimValue(dataType, baseSize, dimensions);
+                values.create(valueReference, dataType, baseSize, dimensions);
                 switch (dataType) {
                     case DcpDataType::int8: {
                         if (var.Output.get()->Int8.get()->start.get() != nullptr) {
@@ -1294,7 +1517,7 @@ protected:
                 } else {
                     dimensions.push_back(1);
                 }
-                values[valueReference] = new MultiDimValue(dataType, baseSize, dimensions);
+                values.create(valueReference, dataType, baseSize, dimensions);
                 switch (dataType) {
                     case DcpDataType::int8: {
                         if (var.Parameter.get()->Int8.get()->start.get() != nullptr) {
@@ -1527,7 +1750,9 @@ protected:
                     Log(IN_OUT_PDU_MISSED);
 #endif
                 }
-                if(maxConsecMissedPduData[dcpPduDatInputOutput.getDataId()] > 0 && maxConsecMissedPduData[dcpPduDatInputOutput.getDataId()] < diff){
+                //find instead of operator[], which would insert concurrently from several receive threads
+                auto maxMissed = maxConsecMissedPduData.find(dcpPduDatInputOutput.getDataId());
+                if(maxMissed != maxConsecMissedPduData.end() && maxMissed->second > 0 && maxMissed->second < diff){
                     gotoErrorHandling();
                     gotoErrorResolved();
                     return false;
@@ -1544,7 +1769,8 @@ protected:
                     Log(PARAM_PDU_MISSED);
 #endif
                 }
-                if(maxConsecMissedPduParam[dcpPduDatParameter.getParamId()] > 0 && maxConsecMissedPduParam[dcpPduDatParameter.getParamId()] < diff){
+                auto maxMissed = maxConsecMissedPduParam.find(dcpPduDatParameter.getParamId());
+                if(maxMissed != maxConsecMissedPduParam.end() && maxMissed->second > 0 && maxMissed->second < diff){
                     gotoErrorHandling();
                     gotoErrorResolved();
                     return false;
@@ -1600,18 +1826,26 @@ protected:
             switch (msg.getTypeId()) {
                 case DcpPduType::DAT_input_output: {
                     DcpPduDatInputOutput &aciPduData = static_cast<DcpPduDatInputOutput &>(msg);
+                    std::shared_ptr<const InputDecodePlans> plans = getInputDecodePlans();
                     size_t correctLength = 0;
-                    for (auto &pos: inputAssignment[aciPduData.getDataId()]) {
-                        switch (pos.second.second) {
-                            case DcpDataType::binary:
-                            case DcpDataType::string:
-                                correctLength += *((uint16_t *) (aciPduData.getPayload() + correctLength)) + 4;
+                    bool complete = aciPduData.getDataId() < plans->plans.size();
+                    if (complete) {
+                        const InputDecodePlan &plan = plans->plans[aciPduData.getDataId()];
+                        size_t payloadSize = aciPduData.getPduSize() - 5;
+                        correctLength = plan.fixedPayloadSize;
+                        size_t offset = 0;
+                        for (size_t gap : plan.variableFieldGaps) {
+                            offset += gap;
+                            if (offset + 4 > payloadSize) {
+                                complete = false;
                                 break;
-                            default:
-                                correctLength += values[pos.second.first]->getPayloadSize();
+                            }
+                            size_t fieldSize = *((uint16_t *) (aciPduData.getPayload() + offset)) + 4;
+                            offset += fieldSize;
+                            correctLength += fieldSize;
                         }
                     }
-                    if (aciPduData.getPduSize() != (correctLength + 5)) {
+                    if (!complete || aciPduData.getPduSize() != (correctLength + 5)) {
 #if defined(DEBUG) || defined(LOGGING)
                         Log(INVALID_LENGTH, (uint16_t) aciPduData.getPduSize(), (uint16_t) (correctLength + 5));
 #endif
@@ -2119,6 +2353,13 @@ protected:
                         error = DcpError::INVALID_TRANSPORT_PROTOCOL;
                         break;
                     }
+                    if (networkInfo.getTransportProtocol() == DcpTransportProtocol::UNIX_DOMAIN) {
+                        DcpPduCfgNetworkInformationPath &networkInfoPath =
+                                static_cast<DcpPduCfgNetworkInformationPath &>(networkInfo);
+                        if (!isUnixDomainPathValid(networkInfoPath, networkInfoPath.getPath())) {
+                            error = DcpError::INVALID_NETWORK_INFORMATION;
+                        }
+                    }
                     break;
                 }
                 case DcpPduType::CFG_source_network_information: {
@@ -2167,6 +2408,30 @@ protected:
                             }
                             break;
                         }
+                        case DcpTransportProtocol::SHARED_MEMORY: {
+                            DcpPduCfgNetworkInformationIPv4 networkInfoShm =
+                                    static_cast<DcpPduCfgNetworkInformationIPv4 &>(networkInfo);
+
+                            if (!slavedescription::isSharedMemoryPortSupportedForInputOutput(slaveDescription,
+                                                                                             networkInfoShm.getPort())) {
+#if defined(DEBUG) || defined(LOGGING)
+                                Log(INVALID_PORT, networkInfoShm.getPort(),
+                                    slavedescription::supportedSharedMemoryPorts(slaveDescription));
+#endif
+                                if (error == DcpError::NONE) {
+                                    error = DcpError::INVALID_NETWORK_INFORMATION;
+                                }
+                            }
+                            break;
+                        }
+                        case DcpTransportProtocol::UNIX_DOMAIN: {
+                            DcpPduCfgNetworkInformationPath &networkInfoPath =
+                                    static_cast<DcpPduCfgNetworkInformationPath &>(networkInfo);
+                            if (!isUnixDomainPathValid(networkInfoPath, networkInfoPath.getPath())) {
+                                error = DcpError::INVALID_NETWORK_INFORMATION;
+                            }
+                            break;
+                        }
                     }
                     break;
                 }
@@ -2263,6 +2528,29 @@ protected:
 
                             break;
                         }
+                        case DcpTransportProtocol::SHARED_MEMORY: {
+                            DcpPduCfgParamNetworkInformationIPv4 paramNetworkInfoShm =
+                                    static_cast<DcpPduCfgParamNetworkInformationIPv4 &>(paramNetworkInfo);
+                            if (!slavedescription::isSharedMemoryPortSupportedForParameter(slaveDescription,
+                                                                                           paramNetworkInfoShm.getPort())) {
+#if defined(DEBUG) || defined(LOGGING)
+                                Log(INVALID_PORT, paramNetworkInfoShm.getPort(),
+                                    slavedescription::supportedSharedMemoryPortsParameter(slaveDescription));
+#endif
+                                if (error == DcpError::NONE) {
+                                    error = DcpError::INVALID_NETWORK_INFORMATION;
+                                }
+                            }
+                            break;
+                        }
+                        case DcpTransportProtocol::UNIX_DOMAIN: {
+                            DcpPduCfgParamNetworkInformationPath &paramNetworkInfoPath =
+                                    static_cast<DcpPduCfgParamNetworkInformationPath &>(paramNetworkInfo);
+                            if (!isUnixDomainPathValid(paramNetworkInfoPath, paramNetworkInfoPath.getPath())) {
+                                error = DcpError::INVALID_NETWORK_INFORMATION;
+                            }
+                            break;
+                        }
                     }
                     break;
                 }
@@ -2409,11 +2697,232 @@ case DcpDataType::input: \
         return false;
     }
 
+    /**
+     * Checks the socket path of a UNIX_DOMAIN network information PDU. It has to be zero terminated
+     * and fit into sockaddr_un, otherwise the driver fails to open or address the socket.
+     */
+    bool isUnixDomainPathValid(DcpPdu &networkInfo, const char *path) {
+        if (!slaveDescription.TransportProtocols.UnixDomain || !networkInfo.isSizeCorrect()
+            || std::strlen(path) > internal::maxUnixDomainPathLength()) {
+#if defined(DEBUG) || defined(LOGGING)
+            Log(INVALID_SOCKET_PATH, std::string(networkInfo.isSizeCorrect() ? path : ""),
+                (uint16_t) internal::maxUnixDomainPathLength());
+#endif
+            return false;
+        }
+        return true;
+    }
+
+    void invalidateInputDecodePlans() {
+        std::atomic_store(&inputDecodePlans, std::shared_ptr<const InputDecodePlans>());
+    }
+
+    /**
+     * Returns the published decode plans, and builds them first if they were invalidated.
+     */
+    std::shared_ptr<const InputDecodePlans> getInputDecodePlans() {
+        std::shared_ptr<const InputDecodePlans> plans = std::atomic_load(&inputDecodePlans);
+        if (plans == nullptr) {
+            std::lock_guard<std::mutex> lock(inputWriteMutex);
+            plans = std::atomic_load(&inputDecodePlans);
+            if (plans == nullptr) {
+                plans = buildInputDecodePlans();
+                std::atomic_store(&inputDecodePlans, plans);
+            }
+        }
+        return plans;
+    }
+
+    /**
+     * Flattens inputAssignment into one decode plan per data id, so applying or validating a
+     * DAT_input_output PDU needs no map lookups. Has to be rebuilt if inputAssignment
+     * changes or input values are reallocated.
+     */
+    std::shared_ptr<const InputDecodePlans> buildInputDecodePlans() {
+        std::shared_ptr<InputDecodePlans> plans = std::make_shared<InputDecodePlans>();
+        if (!inputAssignment.empty()) {
+            plans->plans.resize(inputAssignment.rbegin()->first + 1);
+        }
+        plans->buffered = bufferedInputs;
+        if (bufferedInputs) {
+            buildInputShadows(*plans);
+        }
+        size_t nextShadow = 0;
+        for (auto const &assignment : inputAssignment) {
+            InputDecodePlan &plan = plans->plans[assignment.first];
+            size_t gap = 0;
+            for (auto const &pos : assignment.second) {
+                valueReference_t valueReference = pos.second.first;
+                DcpDataType sourceDataType = pos.second.second;
+                MultiDimValue *value = values[valueReference];
+                InputDecodeStep step;
+                step.shadow = nextShadow;
+                if (bufferedInputs) {
+                    value = &plans->shadows[nextShadow++];
+                }
+                step.destination = value->getValue<uint8_t *>();
+                step.convert = MultiDimValue::getConversionKernel(value->getDataType(), sourceDataType);
+                step.count = value->getNumberOfAssignments();
+                step.sourceSize = step.convert != nullptr ? step.count * getDcpDataTypeSize(sourceDataType) : 0;
+                step.sourceDataType = sourceDataType;
+                step.value = value;
+                step.valueReference = valueReference;
+                plan.steps.push_back(step);
+                if (sourceDataType == DcpDataType::binary || sourceDataType == DcpDataType::string) {
+                    plan.variableFieldGaps.push_back(gap);
+                    gap = 0;
+                } else {
+                    size_t size = step.count * getDcpDataTypeSize(sourceDataType);
+                    plan.fixedPayloadSize += size;
+                    gap += size;
+                }
+            }
+        }
+        return plans;
+    }
+
+    /**
+     * Creates one shadow value per input assignment, in the order of inputAssignment, on one
+     * contiguous storage. The shadows start with the current content of the inputs.
+     */
+    void buildInputShadows(InputDecodePlans &plans) {
+        size_t size = 0;
+        for (auto const &assignment : inputAssignment) {
+            for (auto const &pos : assignment.second) {
+                size += (values[pos.second.first]->getPayloadSize() + 7) & ~((size_t) 7);
+            }
+        }
+        plans.shadowStorage.assign(size, 0);
+        size_t offset = 0;
+        for (auto const &assignment : inputAssignment) {
+            for (auto const &pos : assignment.second) {
+                MultiDimValue *value = values[pos.second.first];
+                uint8_t *storage = plans.shadowStorage.data() + offset;
+                std::memcpy(storage, value->getValue<uint8_t *>(), value->getPayloadSize());
+                plans.shadows.emplace_back(value->getDataType(), value->getBaseSize(), value->getDimensions(), storage);
+                plans.snapshotCopies.push_back(std::make_pair(value, &plans.shadows.back()));
+                offset += (value->getPayloadSize() + 7) & ~((size_t) 7);
+            }
+        }
+        plans.shadowVersions = std::unique_ptr<std::atomic<uint64_t>[]>(
+                new std::atomic<uint64_t>[plans.shadows.size()]);
+        for (size_t i = 0; i < plans.shadows.size(); i++) {
+            plans.shadowVersions[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Copies the last completely received inputs from the shadows to the inputs.
+     * Only has an effect with buffered inputs. Never blocks the receiving thread and never waits
+     * for it: a copy overlapped by a write is retried a few times, after that the inputs keep the
+     * previous snapshot for this step and staleInputSnapshots is counted up.
+     */
+    void loadInputSnapshot() {
+        if (!bufferedInputs) {
+            return;
+        }
+        std::shared_ptr<const InputDecodePlans> plans = std::atomic_load(&inputDecodePlans);
+        if (plans == nullptr || !plans->buffered) {
+            return;
+        }
+        if (plans != inputSnapshotPlans) {
+            inputSnapshotPlans = plans;
+            inputSnapshotVersions.assign(plans->shadows.size(), 0);
+            inputSnapshotReadVersions.assign(plans->shadows.size(), 0);
+            inputSnapshotStaging.assign(plans->shadowStorage.size(), 0);
+        }
+        bool consistent = false;
+        for (int attempt = 0; attempt < maxInputSnapshotAttempts && !consistent; attempt++) {
+            uint32_t seq = inputSeqLock.beginRead();
+            if (seq & 1) {
+                //a decode takes microseconds, give the writer a chance to finish
+                std::this_thread::yield();
+                continue;
+            }
+            inputSnapshotChanged.clear();
+            for (size_t i = 0; i < plans->snapshotCopies.size(); i++) {
+                inputSnapshotReadVersions[i] = plans->shadowVersions[i].load(std::memory_order_relaxed);
+                if (inputSnapshotReadVersions[i] != inputSnapshotVersions[i]) {
+                    MultiDimValue *shadow = plans->snapshotCopies[i].second;
+                    size_t offset = shadow->getValue<uint8_t *>() - plans->shadowStorage.data();
+                    std::memcpy(inputSnapshotStaging.data() + offset, shadow->getValue<uint8_t *>(),
+                                shadow->getPayloadSize());
+                    inputSnapshotChanged.push_back(i);
+                }
+            }
+            consistent = !inputSeqLock.retryRead(seq);
+        }
+        if (!consistent) {
+            staleInputSnapshots.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        for (size_t i : inputSnapshotChanged) {
+            const std::pair<MultiDimValue *, MultiDimValue *> &copy = plans->snapshotCopies[i];
+            size_t offset = copy.second->getValue<uint8_t *>() - plans->shadowStorage.data();
+            std::memcpy(copy.first->getValue<uint8_t *>(), inputSnapshotStaging.data() + offset,
+                        copy.second->getPayloadSize());
+        }
+        inputSnapshotVersions.swap(inputSnapshotReadVersions);
+    }
+
+    /**
+     * Flattens outputAssignment into one encode plan per data id, so serializing the
+     * outputs needs no map lookups. Has to be rebuilt if outputAssignment, the output
+     * buffers or output values change.
+     */
+    void buildOutputEncodePlans() {
+        outputEncodePlans.clear();
+        if (!outputAssignment.empty()) {
+            outputEncodePlans.resize(outputAssignment.rbegin()->first + 1);
+        }
+        for (auto const &assignment : outputAssignment) {
+            OutputEncodePlan &plan = outputEncodePlans[assignment.first];
+            plan.pdu = outputBuffer[assignment.first];
+            for (auto const &pos : assignment.second) {
+                MultiDimValue *value = values[pos.second];
+                DcpDataType dataType = value->getDataType();
+                if (dataType == DcpDataType::string || dataType == DcpDataType::binary) {
+                    plan.steps.push_back({nullptr, 0, value});
+                    continue;
+                }
+                const uint8_t *source = value->getValue<uint8_t *>();
+                size_t size = value->getPayloadSize();
+                if (!plan.steps.empty() && plan.steps.back().source != nullptr &&
+                    plan.steps.back().source + plan.steps.back().size == source) {
+                    plan.steps.back().size += size;
+                } else {
+                    plan.steps.push_back({source, size, nullptr});
+                }
+            }
+        }
+        outputEncodePlansValid = true;
+    }
+
+    /**
+     * Serializes all outputs assigned to the data id of plan into its PDU.
+     * @return number of payload bytes written
+     */
+    size_t applyOutputEncodePlan(const OutputEncodePlan &plan) {
+        uint8_t *payload = plan.pdu->getPayload();
+        size_t offset = 0;
+        for (const OutputEncodeStep &step : plan.steps) {
+            if (step.source != nullptr) {
+                std::memcpy(payload + offset, step.source, step.size);
+                offset += step.size;
+            } else {
+                offset += step.value->serialize(payload, offset);
+            }
+        }
+        return offset;
+    }
+
     void clearOutputBuffer() {
         for (auto const &ent : outputBuffer) {
             delete ent.second;
         }
         outputBuffer.clear();
+        outputEncodePlans.clear();
+        outputEncodePlansValid = false;
     }
 
     void clearConfig() {
@@ -2421,6 +2930,7 @@ case DcpDataType::input: \
 
         inputAssignment.clear();
         configuredInPos.clear();
+        invalidateInputDecodePlans();
 
         outputAssignment.clear();
         configuredOutPos.clear();
@@ -2432,8 +2942,11 @@ case DcpDataType::input: \
         segNumsOut.clear();
         segNumsIn.clear();
         dataSegNumsOut.clear();
-        dataSegNumsIn.clear();
-        parameterSegNumsIn.clear();
+        {
+            std::lock_guard<std::mutex> lock(segNumsInMutex);
+            dataSegNumsIn.clear();
+            parameterSegNumsIn.clear();
+        }
 
         steps.clear();
         runningScope.clear();
@@ -2471,22 +2984,22 @@ case DcpDataType::input: \
             size_t pos = dependency.second;
             std::vector<size_t> newDimensions(values[vrToUpdate]->getDimensions());
             newDimensions[pos] = value;
+            invalidateInputDecodePlans();
+            outputEncodePlansValid = false;
             if (slavedescription::inputExists(slaveDescription, vrToUpdate) ||
                 slavedescription::outputExists(slaveDescription, vrToUpdate)) {
-                values[vrToUpdate] = new MultiDimValue(slavedescription::getDataType(slaveDescription, vrToUpdate),
-                                                       values[vrToUpdate]->getBaseSize(), newDimensions);
+                values.resize(vrToUpdate, newDimensions);
             } else {
-                updatedStructure[vrToUpdate] = new MultiDimValue(
-                        slavedescription::getDataType(slaveDescription, vrToUpdate),
-                        values[vrToUpdate]->getBaseSize(), newDimensions);
+                updatedStructure[vrToUpdate] = newDimensions;
             }
         }
     }
 
     void checkForUpdatedStructure(uint64_t valueReference) {
         if (updatedStructure.count(valueReference)) {
-            delete values[valueReference];
-            values[valueReference] = updatedStructure[valueReference];
+            invalidateInputDecodePlans();
+            outputEncodePlansValid = false;
+            values.resize(valueReference, updatedStructure[valueReference]);
             updatedStructure.erase(valueReference);
         }
     }
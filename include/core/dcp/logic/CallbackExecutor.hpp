@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_CALLBACKEXECUTOR_HPP
+#define DCPLIB_CALLBACKEXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dcp/model/DcpCallbackTypes.hpp>
+
+namespace internal {
+    /**
+     * Bounded lock-free multi producer multi consumer queue.
+     * Each cell carries a sequence number which tells producers and consumers whose turn it is.
+     */
+    template<typename T>
+    class BoundedMpmcQueue {
+    public:
+        /**
+         * @param capacity Maximum number of queued items. Rounded up to the next power of two.
+         */
+        explicit BoundedMpmcQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) {
+                size *= 2;
+            }
+            mask = size - 1;
+            cells = std::unique_ptr<Cell[]>(new Cell[size]);
+            for (size_t i = 0; i < size; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            enqueuePos.store(0, std::memory_order_relaxed);
+            dequeuePos.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @return False if the queue is full. item is left untouched then.
+         */
+        bool push(T &item) {
+            Cell *cell;
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+                if (diff == 0) {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(item);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @return False if the queue is empty
+         */
+        bool pop(T &item) {
+            Cell *cell;
+            size_t pos = dequeuePos.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+                if (diff == 0) {
+                    if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+            item = std::move(cell->data);
+            cell->data = T();
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        char pad0[64];
+        std::atomic<size_t> enqueuePos;
+        char pad1[64];
+        std::atomic<size_t> dequeuePos;
+        char pad2[64];
+    };
+}
+
+/**
+ * Fixed size worker pool which executes ASYNC callbacks.
+ * Every worker owns a bounded queue. Callbacks of an ordered callback type are always queued
+ * to the same worker, so they are executed in the order they were posted. Callbacks of
+ * unordered types are distributed round robin. Callbacks posted with an ordering key are
+ * queued by key instead, so all callbacks of one key keep their order across types.
+ * A callback which does not fit into the queue of its worker is dropped and counted as overflow.
+ * The workers are started with the first posted callback. Once stopped, the executor rejects all callbacks.
+ */
+class CallbackExecutor {
+public:
+    CallbackExecutor() : numWorkers(2), queueCapacity(1024), started(false), stopped(false), overflows(0), pending(0), highWaterMark(0),
+                         nextWorker(0) {
+        for (size_t i = 0; i < maxCallbackTypes; i++) {
+            ordered[i] = true;
+        }
+    }
+
+    ~CallbackExecutor() {
+        stop();
+    }
+
+    CallbackExecutor(const CallbackExecutor &) = delete;
+
+    CallbackExecutor &operator=(const CallbackExecutor &) = delete;
+
+    /**
+     * Set the number of worker threads and the queue capacity of each worker.
+     * @return False if the executor is already running and nothing was changed
+     */
+    bool configure(size_t numWorkers, size_t queueCapacity) {
+        std::lock_guard<std::mutex> lock(mtxStart);
+        if (started) {
+            return false;
+        }
+        this->numWorkers = numWorkers > 0 ? numWorkers : 1;
+        this->queueCapacity = queueCapacity > 0 ? queueCapacity : 1;
+        return true;
+    }
+
+    /**
+     * Set whether callbacks of the given type are executed in the order they were posted. Default is true.
+     */
+    void setOrdered(DcpCallbackTypes type, bool ordered) {
+        this->ordered[(size_t) type] = ordered;
+    }
+
+    /**
+     * Queue a callback for execution.
+     * @return False if the queue was full and the callback was dropped, or the executor is stopped
+     */
+    bool post(DcpCallbackTypes type, std::function<void()> task) {
+        if (!started.load(std::memory_order_acquire) && !start()) {
+            return false;
+        }
+        size_t index;
+        if (ordered[(size_t) type]) {
+            index = (size_t) type % workers.size();
+        } else {
+            index = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        }
+        return push(*workers[index], task);
+    }
+
+    /**
+     * Queue a callback for execution. Callbacks with the same key are executed in the order
+     * they were posted, regardless of their type.
+     * @return False if the queue was full and the callback was dropped, or the executor is stopped
+     */
+    bool post(size_t key, std::function<void()> task) {
+        if (!started.load(std::memory_order_acquire) && !start()) {
+            return false;
+        }
+        return push(*workers[key % workers.size()], task);
+    }
+
+    /**
+     * @return Number of callbacks dropped because of a full queue
+     */
+    uint64_t getOverflowCount() const {
+        return overflows;
+    }
+
+    /**
+     * @return Number of callbacks queued but not yet started
+     */
+    size_t getQueueDepth() const {
+        return pending;
+    }
+
+    /**
+     * @return Maximum number of queued callbacks since start or the last reset
+     */
+    size_t getHighWaterMark() const {
+        return highWaterMark;
+    }
+
+    void resetHighWaterMark() {
+        highWaterMark = pending.load();
+    }
+
+    /**
+     * Stops all workers after their running callback. Callbacks still queued are discarded,
+     * callbacks posted afterwards are rejected. The workers are freed with the executor only,
+     * so a post racing with stop never touches freed memory.
+     */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mtxStart);
+        if (stopped) {
+            return;
+        }
+        stopped.store(true, std::memory_order_release);
+        for (std::unique_ptr<Worker> &worker : workers) {
+            std::lock_guard<std::mutex> workerLock(worker->mtx);
+            worker->shutdown = true;
+            worker->cv.notify_one();
+        }
+        std::function<void()> task;
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread.join();
+            while (worker->queue.pop(task)) {
+                task = nullptr;
+            }
+        }
+        pending = 0;
+    }
+
+private:
+    enum {
+        maxCallbackTypes = 32
+    };
+
+    struct Worker {
+        explicit Worker(size_t capacity) : queue(capacity), sleeping(false), shutdown(false) {}
+
+        internal::BoundedMpmcQueue<std::function<void()>> queue;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::atomic_bool sleeping;
+        std::atomic_bool shutdown;
+        std::thread thread;
+    };
+
+    size_t numWorkers;
+    size_t queueCapacity;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex mtxStart;
+    std::atomic_bool started;
+    std::atomic_bool stopped;
+    std::atomic_bool ordered[maxCallbackTypes];
+    std::atomic<uint64_t> overflows;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> highWaterMark;
+    std::atomic<size_t> nextWorker;
+
+    bool push(Worker &worker, std::function<void()> &task) {
+        if (stopped.load(std::memory_order_acquire)) {
+            return false;
+        }
+        //counted before the push, so a worker never decrements below zero
+        size_t depth = ++pending;
+        if (!worker.queue.push(task)) {
+            pending--;
+            overflows++;
+            return false;
+        }
+        size_t max = highWaterMark.load(std::memory_order_relaxed);
+        while (depth > max && !highWaterMark.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (worker.sleeping.load()) {
+            std::lock_guard<std::mutex> lock(worker.mtx);
+            worker.cv.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * @return False if the executor is stopped
+     */
+    bool start() {
+        std::lock_guard<std::mutex> lock(mtxStart);
+        if (stopped) {
+            return false;
+        }
+        if (started) {
+            return true;
+        }
+        for (size_t i = 0; i < numWorkers; i++) {
+            workers.push_back(std::unique_ptr<Worker>(new Worker(queueCapacity)));
+        }
+        for (std::unique_ptr<Worker> &worker : workers) {
+            worker->thread = std::thread(&CallbackExecutor::work, this, std::ref(*worker));
+        }
+        started.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void work(Worker &worker) {
+        std::function<void()> task;
+        while (!worker.shutdown) {
+            if (worker.queue.pop(task)) {
+                pending--;
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(worker.mtx);
+            worker.sleeping = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            worker.cv.wait(lock, [&worker, &task] {
+                return worker.shutdown || worker.queue.pop(task);
+            });
+            worker.sleeping = false;
+            if (worker.shutdown) {
+                return;
+            }
+            lock.unlock();
+            pending--;
+            task();
+            task = nullptr;
+        }
+    }
+};
+
+#endif //DCPLIB_CALLBACKEXECUTOR_HPP
@@ -269,4 +269,13 @@ static const LogTemplate OP_MODE_SET = LogTemplate(logId++, LogCategory::DCP_LIB
 static const LogTemplate INVALID_STATE_ID = LogTemplate(logId++, LogCategory::DCP_LIB_SLAVE, DcpLogLevel::LVL_ERROR,
                                                  "State id (%uint8) in received state change PDU do not match current state (%uint8).",
                                                  {DcpDataType::state, DcpDataType::state});
+static const LogTemplate REALTIME_SCHEDULING_FAILED = LogTemplate(logId++, LogCategory::DCP_LIB_SLAVE, DcpLogLevel::LVL_WARNING,
+                                                           "Realtime scheduling of the executor could not be applied: %string.",
+                                                           {DcpDataType::string});
+static const LogTemplate REALTIME_DEADLINE_MISSED = LogTemplate(logId++, LogCategory::DCP_LIB_SLAVE, DcpLogLevel::LVL_DEBUG,
+                                                         "Realtime step finished %int64 us after its deadline.",
+                                                         {DcpDataType::int64});
+static const LogTemplate INVALID_SOCKET_PATH = LogTemplate(logId++, LogCategory::DCP_LIB_SLAVE, DcpLogLevel::LVL_ERROR,
+                                                    "Socket path \"%string\" is not supported. It has to be zero terminated and at most %uint16 characters long.",
+                                                    {DcpDataType::string, DcpDataType::uint16});
 #endif //DCPLIB_DCPSLAVEERRORCODES_HPP
@@ -12,10 +12,16 @@
 
 #include <dcp/model/pdu/DcpPdu.hpp>
 #include <dcp/model/constant/DcpError.hpp>
+#include <dcp/helper/BufferPool.hpp>
 #include <functional>
 struct DcpManager{
     std::function<void(DcpPdu&)> receive;
     std::function<void(const DcpError)> reportError;
+    /**
+     * Optional. Called instead of receive by drivers which received the PDU into a pooled buffer.
+     * The manager may keep references to the buffer beyond the call.
+     */
+    std::function<void(DcpPdu&, const PooledBuffer&)> receiveBuffer;
 };
 
 #endif //DCPLIB_DCPMANAGERCALLBACKS_H
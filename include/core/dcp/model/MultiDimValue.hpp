@@ -12,46 +12,69 @@
 
 
 #include <vector>
+#include <cstring>
 #include <dcp/helper/Helper.hpp>
+#include <dcp/helper/ConversionKernels.hpp>
 #include <dcp/model/constant/DcpDataType.hpp>
 #include <dcp/model/DcpString.hpp>
 #include <dcp/model/DcpBinary.hpp>
 
 
-#define CAST(T1, T2)\
-    for(int i = 0; i < numberOfAssignments; i++){\
-        *((T1*)(payload + offset)) = *((T2*)(newPayload + (start + otherOffset)));\
-        offset += baseSize;\
-        otherOffset += otherBaseSize;\
-    }
-
-#define INNER_CASE_CAST(val, T1, T2) \
-		case DcpDataType::val : \
-		 	 CAST(T1, T2) \
-		 	 break;
-
-#define INNER_SWITCH_START switch(sourceDataType){
-#define INNER_SWITCH_END \
-        default: \
-        break;\
-    } \
-    break;
-
 class MultiDimValue{
 public:
     MultiDimValue(DcpDataType dataType, size_t baseSize, const std::vector<size_t> dimensions) : dataType(dataType),
                                                                                                   baseSize(baseSize),
                                                                                                   dimensions(
                                                                                                           dimensions) {
-        numberOfAssignments = 1;
-        for(size_t dim : dimensions){
-            numberOfAssignments *= dim;
-        }
+        numberOfAssignments = getNumberOfAssignments(dimensions);
         payload = new uint8_t[numberOfAssignments * baseSize];
+        ownsPayload = true;
+        kernels = ::getConversionKernels(dataType);
     }
 
+    /**
+     * Creates a value on external storage, which must hold baseSize * number of assignments bytes
+     * and outlive this value.
+     */
+    MultiDimValue(DcpDataType dataType, size_t baseSize, const std::vector<size_t> dimensions, uint8_t *storage)
+            : dataType(dataType), baseSize(baseSize), dimensions(dimensions) {
+        numberOfAssignments = getNumberOfAssignments(dimensions);
+        payload = storage;
+        ownsPayload = false;
+        kernels = ::getConversionKernels(dataType);
+    }
+
+    MultiDimValue(const MultiDimValue &) = delete;
+
+    MultiDimValue &operator=(const MultiDimValue &) = delete;
+
     ~MultiDimValue(){
-        delete[] payload;
+        if (ownsPayload) {
+            delete[] payload;
+        }
+    }
+
+    /**
+     * Moves this value to new external storage with new dimensions. The content is not copied.
+     * @param storage memory for baseSize * number of assignments of newDimensions bytes
+     * @param newDimensions new dimensions of the value
+     */
+    void relocate(uint8_t *storage, const std::vector<size_t> &newDimensions) {
+        if (ownsPayload) {
+            delete[] payload;
+        }
+        payload = storage;
+        ownsPayload = false;
+        dimensions = newDimensions;
+        numberOfAssignments = getNumberOfAssignments(newDimensions);
+    }
+
+    static size_t getNumberOfAssignments(const std::vector<size_t> &dimensions) {
+        size_t numberOfAssignments = 1;
+        for (size_t dim : dimensions) {
+            numberOfAssignments *= dim;
+        }
+        return numberOfAssignments;
     }
 
     template<typename T>
@@ -63,88 +86,9 @@ public:
     size_t update(const uint8_t* newPayload, size_t start, DcpDataType sourceDataType){
         size_t offset = 0;
         size_t otherOffset = 0;
-        size_t otherBaseSize = getDcpDataTypeSize(sourceDataType);
         switch (dataType) {
-            case DcpDataType::uint8:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(uint8, uint8_t, uint8_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::uint16:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(uint8, uint16_t, uint8_t)
-                    INNER_CASE_CAST(uint16, uint16_t, uint16_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::uint32:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(uint8, uint32_t, uint8_t)
-                    INNER_CASE_CAST(uint16, uint32_t, uint16_t)
-                    INNER_CASE_CAST(uint32, uint32_t, uint32_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::uint64:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(uint8, uint64_t, uint8_t)
-                    INNER_CASE_CAST(uint16, uint64_t, uint16_t)
-                    INNER_CASE_CAST(uint32, uint64_t, uint32_t)
-                    INNER_CASE_CAST(uint64, uint64_t, uint64_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::int8:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, int8_t, int8_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::int16:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, int16_t, int8_t)
-                    INNER_CASE_CAST(int16, int16_t, int16_t)
-                    INNER_CASE_CAST(uint8, int16_t, uint8_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::int32:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, int32_t, int8_t)
-                    INNER_CASE_CAST(int16, int32_t, int16_t)
-                    INNER_CASE_CAST(int32, int32_t, int32_t)
-                    INNER_CASE_CAST(uint8, int32_t, uint8_t)
-                    INNER_CASE_CAST(uint16, int32_t, uint16_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::int64:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, int64_t, int8_t)
-                    INNER_CASE_CAST(int16, int64_t, int16_t)
-                    INNER_CASE_CAST(int32, int64_t, int32_t)
-                    INNER_CASE_CAST(int64, int64_t, int64_t)
-                    INNER_CASE_CAST(uint8, int64_t, uint8_t)
-                    INNER_CASE_CAST(uint16, int64_t, uint16_t)
-                    INNER_CASE_CAST(uint32, int64_t, uint32_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::float32:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, float32_t, int8_t)
-                    INNER_CASE_CAST(int16, float32_t, int16_t)
-                    INNER_CASE_CAST(uint8, float32_t, uint8_t)
-                    INNER_CASE_CAST(uint16, float32_t, uint16_t)
-                    INNER_CASE_CAST(float32, float32_t, float32_t)
-            INNER_SWITCH_END
-
-            case DcpDataType::float64:
-                INNER_SWITCH_START //
-                    INNER_CASE_CAST(int8, float64_t, int8_t)
-                    INNER_CASE_CAST(int16, float64_t, int16_t)
-                    INNER_CASE_CAST(int32, float64_t, int32_t)
-                    INNER_CASE_CAST(uint8, float64_t, uint8_t)
-                    INNER_CASE_CAST(uint16, float64_t, uint16_t)
-                    INNER_CASE_CAST(uint32, float64_t, uint32_t)
-                    INNER_CASE_CAST(float32, float64_t, float32_t)
-                    INNER_CASE_CAST(float64, float64_t, float64_t)
-            INNER_SWITCH_END
             case DcpDataType::binary:
-            case DcpDataType::string:
+            case DcpDataType::string: {
                 bool invalidPayload = false;
                 for (int i = 0; i < numberOfAssignments; i++) {
                         uint32_t& length = *((uint32_t*)(payload + offset));
@@ -163,9 +107,18 @@ public:
                 if(invalidPayload) {
                     throw std::range_error("maxSize exceeded");
                 }
+                return otherOffset;
+            }
+            default:
                 break;
         }
-        return otherOffset;
+        uint8_t source = (uint8_t) sourceDataType;
+        ConversionKernel kernel = source < NUM_VALUE_DATA_TYPES ? kernels[source] : nullptr;
+        if (kernel == nullptr) {
+            return 0;
+        }
+        kernel(payload, newPayload + start, numberOfAssignments);
+        return numberOfAssignments * getDcpDataTypeSize(sourceDataType);
     }
 
     inline size_t serialize(uint8_t* output, size_t start){
@@ -193,6 +146,21 @@ public:
         return otherOffset;
     }
 
+    /**
+     * Returns the kernel converting fixed size values of sourceDataType to targetDataType.
+     * @return the kernel, or nullptr if the types are variable sized or the conversion is not allowed
+     */
+    static ConversionKernel getConversionKernel(DcpDataType targetDataType, DcpDataType sourceDataType) {
+        return ::getConversionKernel(targetDataType, sourceDataType);
+    }
+
+    /**
+     * Number of elements of this value.
+     */
+    inline size_t getNumberOfAssignments(){
+        return numberOfAssignments;
+    }
+
     inline DcpDataType getDataType(){
         return dataType;
     }
@@ -225,6 +193,9 @@ private:
     size_t baseSize;
     size_t numberOfAssignments;
     uint8_t* payload;
+    bool ownsPayload;
+    //conversion kernels to dataType, indexed by source data type
+    const ConversionKernel* kernels;
 
     std::vector<size_t> dimensions;
 
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_VALUEHANDLE_HPP
+#define DCPLIB_VALUEHANDLE_HPP
+
+#include <cstddef>
+#include <dcp/model/MultiDimValue.hpp>
+
+/**
+ * Typed access to an input, output or parameter of a slave, resolved once by value reference.
+ * The handle keeps the value itself, which never moves in memory. Each access reads the current
+ * payload of the value, so the handle stays valid when a structural parameter reallocates it.
+ * @tparam T Element type of the value. E. g. uint16_t for uint16.
+ */
+template<typename T>
+class ValueHandle {
+public:
+    ValueHandle() : value(nullptr) {}
+
+    explicit ValueHandle(MultiDimValue *value) : value(value) {}
+
+    /**
+     * @return Pointer to the first element of the value
+     */
+    T *get() const {
+        return value->getValue<T *>();
+    }
+
+    T &operator*() const {
+        return *get();
+    }
+
+    T *operator->() const {
+        return get();
+    }
+
+    T &operator[](size_t index) const {
+        return get()[index];
+    }
+
+    /**
+     * @return Current number of elements of the value
+     */
+    size_t size() const {
+        return value->getNumberOfAssignments();
+    }
+
+    explicit operator bool() const {
+        return value != nullptr;
+    }
+
+private:
+    MultiDimValue *value;
+};
+
+#endif //DCPLIB_VALUEHANDLE_HPP
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universität Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_VALUESTORE_HPP
+#define DCPLIB_VALUESTORE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <dcp/model/DcpTypes.hpp>
+#include <dcp/model/MultiDimValue.hpp>
+
+/**
+ * Storage for all values (inputs, outputs, parameters) of a slave.
+ * The payloads are laid out densely in cache line aligned arena chunks, the value objects
+ * themselves in one deque, and value references are resolved through a flat index.
+ * Values never move in memory: a resize relocates at most the payload of a value, so
+ * MultiDimValue pointers stay valid for the lifetime of the store. Regions left by a relocated
+ * payload are reused for later allocations.
+ */
+class ValueStore {
+public:
+    ValueStore() : current(nullptr), remaining(0) {}
+
+    ~ValueStore() {
+        slots.clear();
+        for (uint8_t *block : blocks) {
+            delete[] block;
+        }
+    }
+
+    ValueStore(const ValueStore &) = delete;
+
+    ValueStore &operator=(const ValueStore &) = delete;
+
+    /**
+     * Creates the value for vr with its payload in the arena.
+     * If a value for vr already exists, it is resized to dimensions instead.
+     * @return the value of vr
+     */
+    MultiDimValue *create(valueReference_t vr, DcpDataType dataType, size_t baseSize,
+                          const std::vector<size_t> &dimensions) {
+        MultiDimValue *existing = operator[](vr);
+        if (existing != nullptr) {
+            resize(vr, dimensions);
+            return existing;
+        }
+        size_t size = baseSize * MultiDimValue::getNumberOfAssignments(dimensions);
+        size_t capacity;
+        slots.emplace_back(dataType, baseSize, dimensions, allocate(size, capacity));
+        capacities.push_back(capacity);
+        size_t slot = slots.size() - 1;
+        if (vr < maxFlatIndex) {
+            if (flatIndex.size() <= vr) {
+                flatIndex.resize(vr + 1, NO_SLOT);
+            }
+            flatIndex[vr] = slot;
+        } else {
+            sparseIndex[vr] = slot;
+        }
+        return &slots.back();
+    }
+
+    /**
+     * Resizes the payload of vr to dimensions. The current region is kept if it is large enough,
+     * otherwise the payload moves to another region and the current one is freed for reuse.
+     * The content of the value is not preserved.
+     */
+    void resize(valueReference_t vr, const std::vector<size_t> &dimensions) {
+        size_t slot = findSlot(vr);
+        if (slot == NO_SLOT) {
+            return;
+        }
+        MultiDimValue &value = slots[slot];
+        size_t size = value.getBaseSize() * MultiDimValue::getNumberOfAssignments(dimensions);
+        if (size <= capacities[slot]) {
+            value.relocate(value.getValue<uint8_t *>(), dimensions);
+            return;
+        }
+        uint8_t *old = value.getValue<uint8_t *>();
+        size_t oldCapacity = capacities[slot];
+        value.relocate(allocate(size, capacities[slot]), dimensions);
+        freeRegions.insert(std::make_pair(oldCapacity, old));
+    }
+
+    /**
+     * @return the value of vr, or nullptr if vr is unknown
+     */
+    MultiDimValue *operator[](valueReference_t vr) {
+        size_t slot = findSlot(vr);
+        return slot == NO_SLOT ? nullptr : &slots[slot];
+    }
+
+    bool contains(valueReference_t vr) {
+        return operator[](vr) != nullptr;
+    }
+
+    size_t size() const {
+        return slots.size();
+    }
+
+private:
+    enum : size_t {
+        CACHE_LINE = 64,
+        CHUNK_SIZE = 64 * 1024,
+        //payloads larger than this get an own, not zeroed block
+        MAX_ARENA_PAYLOAD = 1024 * 1024,
+        NO_SLOT = SIZE_MAX,
+    };
+    //value references below this are resolved through flatIndex
+    static const valueReference_t maxFlatIndex = 1 << 16;
+
+    std::deque<MultiDimValue> slots;
+    std::vector<size_t> flatIndex;
+    std::unordered_map<valueReference_t, size_t> sparseIndex;
+    //size of the arena region of each slot, a resize within it reuses the region
+    std::vector<size_t> capacities;
+
+    std::vector<uint8_t *> blocks;
+    //regions left by relocated payloads, by size
+    std::multimap<size_t, uint8_t *> freeRegions;
+    uint8_t *current;
+    size_t remaining;
+
+    size_t findSlot(valueReference_t vr) {
+        if (vr < flatIndex.size()) {
+            return flatIndex[vr];
+        } else if (vr >= maxFlatIndex) {
+            auto it = sparseIndex.find(vr);
+            if (it != sparseIndex.end()) {
+                return it->second;
+            }
+        }
+        return NO_SLOT;
+    }
+
+    static uint8_t *alignUp(uint8_t *ptr, size_t alignment) {
+        uintptr_t p = (uintptr_t) ptr;
+        return (uint8_t *) ((p + alignment - 1) & ~((uintptr_t) alignment - 1));
+    }
+
+    //small values are packed on their natural alignment, larger ones start on a cache line
+    static size_t alignmentOf(size_t size) {
+        size_t alignment = CACHE_LINE;
+        if (size < CACHE_LINE) {
+            alignment = 8;
+            while (alignment > 1 && size % alignment != 0) {
+                alignment /= 2;
+            }
+        }
+        return alignment;
+    }
+
+    /**
+     * @param capacity Set to the size of the returned region, which may be larger than size if it was reused
+     */
+    uint8_t *allocate(size_t size, size_t &capacity) {
+        size_t alignment = alignmentOf(size);
+        for (auto it = freeRegions.lower_bound(size); it != freeRegions.end(); ++it) {
+            if ((uintptr_t) it->second % alignment == 0) {
+                uint8_t *storage = it->second;
+                capacity = it->first;
+                freeRegions.erase(it);
+                //new arena regions are zeroed, so are reused ones
+                std::memset(storage, 0, size);
+                return storage;
+            }
+        }
+        capacity = size;
+        if (size > MAX_ARENA_PAYLOAD) {
+            uint8_t *block = new uint8_t[size + CACHE_LINE];
+            blocks.push_back(block);
+            return alignUp(block, CACHE_LINE);
+        }
+        size_t padding = current == nullptr ? 0 : alignUp(current, alignment) - current;
+        if (current == nullptr || padding + size > remaining) {
+            uint8_t *block = new uint8_t[CHUNK_SIZE + CACHE_LINE]();
+            blocks.push_back(block);
+            current = alignUp(block, CACHE_LINE);
+            remaining = CHUNK_SIZE;
+            padding = 0;
+        }
+        uint8_t *storage = current + padding;
+        current += padding + size;
+        remaining -= padding + size;
+        return storage;
+    }
+};
+
+#endif //DCPLIB_VALUESTORE_HPP
@@ -39,6 +39,16 @@ enum class DcpTransportProtocol : uint8_t {
      * TCP over Ipv4
      */
     TCP_IPv4 = 4,
+    /**
+     * POSIX shared memory between processes on one host. Not part of the DCP specification.
+     * Endpoints are addressed like TCP_IPv4 and UDP_IPv4, by port and ip address.
+     */
+    SHARED_MEMORY = 0x80,
+    /**
+     * Unix domain datagram sockets between processes on one host. Not part of the DCP specification.
+     * Endpoints are addressed by the zero terminated path of the socket.
+     */
+    UNIX_DOMAIN = 0x81,
 
 };
 
@@ -60,6 +70,10 @@ static std::ostream &operator<<(std::ostream &os, DcpTransportProtocol transport
             return os << "USB";
         case DcpTransportProtocol::TCP_IPv4:
             return os << "TCP_IPv4";
+        case DcpTransportProtocol::SHARED_MEMORY:
+            return os << "SHARED_MEMORY";
+        case DcpTransportProtocol::UNIX_DOMAIN:
+            return os << "UNIX_DOMAIN";
         default:
             return os << "UNKNOWN(" << (unsigned((uint8_t) transportProtocol)) << ")";
     }
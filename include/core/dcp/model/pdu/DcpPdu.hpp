@@ -25,6 +25,7 @@
 #include "dcp/helper/Helper.hpp"
 #include "dcp/model/constant/DcpPduType.hpp"
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -134,6 +135,19 @@ public:
     }
 #endif
 
+    /**
+     * Number of heap allocations done for DcpPdus since program start. This covers
+     * views created by makeDcpPdu and streams allocated by DcpPdus owning their data.
+     * @return number of allocations
+     */
+    static uint64_t getAllocationCount() {
+        return allocationCounter().load(std::memory_order_relaxed);
+    }
+
+    static void countAllocation() {
+        allocationCounter().fetch_add(1, std::memory_order_relaxed);
+    }
+
     void setPduSize(size_t pduSize) {
         this->stream_size = pduSize + PDU_LENGTH_INDICATOR_SIZE;
         *((uint32_t*) this->stream) = pduSize;
@@ -162,10 +176,17 @@ protected:
      */
     DcpPdu(size_t pduSize, DcpPduType type) {
         stream = new unsigned char[pduSize + PDU_LENGTH_INDICATOR_SIZE];
+        countAllocation();
         getTypeId() = type;
         setPduSize(pduSize);
         this->deleteStream = true;
     }
+
+private:
+    static std::atomic<uint64_t> &allocationCounter() {
+        static std::atomic<uint64_t> counter(0);
+        return counter;
+    }
 };
 
 #endif //DCPLIB_DCPPDU_HPP
\ No newline at end of file
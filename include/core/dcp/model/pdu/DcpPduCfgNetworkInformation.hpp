@@ -12,6 +12,8 @@
 
 #include <dcp/model/pdu/DcpPduBasic.hpp>
 #include <dcp/model/pdu/IpToStr.hpp>
+#include <cstring>
+#include <string>
 /**
  * This class decscribes the structure for the Pdus "CFG_target_network_information" & "CFG_source_network_information".
  */
@@ -160,4 +162,71 @@ protected:
     }
 };
 
+/**
+ * This class decscribes the structure for the Pdus "CFG_target_network_information" & "CFG_source_network_information" for UNIX_DOMAIN.
+ * The network information is the zero terminated path of the socket.
+ */
+class DcpPduCfgNetworkInformationPath : public DcpPduCfgNetworkInformation {
+public:
+
+    /**
+     * Get the socket path.
+     *@return the zero terminated socket path.
+     */
+    GET_FUN_PTR(getPath, char, 7)
+
+    /**
+    /* Creates a DcpPduCfgNetworkInformationPath from existing byte array.
+    /* stream byte array containg pdu data. Will not be deleted on DcpPdu destructor.
+    /* stream_size number of bytes in stream.
+    */
+    DcpPduCfgNetworkInformationPath(unsigned char *stream, size_t stream_size) : DcpPduCfgNetworkInformation(stream, stream_size){}
+
+    /**
+     * Creates a new DcpPduCfgNetworkInformationPath object.
+     * @param type_id the type id.
+     * @param pdu_seq_id the pdu seq id.
+     * @param receiver the receiver.
+     * @param data_id  the data id .
+     * @param path the socket path.
+     * @param transportProtocol the transport protocol.
+     */
+    DcpPduCfgNetworkInformationPath(const DcpPduType type_id, const uint16_t pdu_seq_id, const uint8_t receiver,
+                                    const uint16_t data_id, const std::string &path,
+                                    DcpTransportProtocol transportProtocol) :
+            DcpPduCfgNetworkInformation(8 + path.size(), type_id, pdu_seq_id, receiver, data_id, transportProtocol) {
+        memcpy(getPath(), path.c_str(), path.size() + 1);
+    }
+
+#if defined(DEBUG) || defined(LOGGING)
+    /**
+     * Writes the Pdu in a human readable format to the given stream.
+     * @param os stream to write on.
+     */
+    virtual std::ostream &operator<<(std::ostream &os) {
+        DcpPduCfgNetworkInformation::operator<<(os);
+        if (isSizeCorrect()) {
+            os << " path=" << getPath();
+        }
+        return os;
+    }
+#endif
+
+    /**
+     * Check if the stream_size is large enough for a zero terminated path of at least one character.
+     * @return the path fits into stream_size and is zero terminated
+     */
+    virtual bool isSizeCorrect() {
+        return this->stream_size - PDU_LENGTH_INDICATOR_SIZE >= 9 && this->stream[this->stream_size - 1] == 0;
+    }
+
+    /**
+     * Returns the minimum stream_size, a path of one character.
+     * @return the minimum stream_size
+     */
+    virtual size_t getCorrectSize() {
+        return 9;
+    }
+};
+
 #endif //DCPLIB_DCPPDUCFGNETWORKINFORMATION_HPP
@@ -12,6 +12,8 @@
 
 #include <dcp/model/pdu/DcpPduBasic.hpp>
 #include <dcp/model/pdu/IpToStr.hpp>
+#include <cstring>
+#include <string>
 
 /**
  * This class decscribes the structure for the Pdus "CFG_target_network_information" & "MSG_source_network_information".
@@ -160,4 +162,70 @@ protected:
     }
 };
 
+/**
+ * This class decscribes the structure for the Pdus "CFG_param_network_information" for UNIX_DOMAIN.
+ * The network information is the zero terminated path of the socket.
+ */
+class DcpPduCfgParamNetworkInformationPath : public DcpPduCfgParamNetworkInformation {
+public:
+
+    /**
+     * Get the socket path.
+     *@return the zero terminated socket path.
+     */
+    GET_FUN_PTR(getPath, char, 7)
+
+    /**
+    /* Creates a DcpPduCfgParamNetworkInformationPath from existing byte array.
+    /* stream byte array containg pdu data. Will not be deleted on DcpPdu destructor.
+    /* stream_size number of bytes in stream.
+    */
+    DcpPduCfgParamNetworkInformationPath(unsigned char *stream, size_t stream_size) : DcpPduCfgParamNetworkInformation(stream, stream_size){}
+
+    /**
+     * Creates a new DcpPduCfgParamNetworkInformationPath object.
+     * @param pdu_seq_id the pdu seq id.
+     * @param receiver the receiver.
+     * @param param_id  the param_id .
+     * @param path the socket path.
+     * @param transportProtocol the transport protocol.
+     */
+    DcpPduCfgParamNetworkInformationPath(const uint16_t pdu_seq_id, const uint8_t receiver, const uint16_t param_id,
+                                         const std::string &path, DcpTransportProtocol transportProtocol) :
+            DcpPduCfgParamNetworkInformation(8 + path.size(), DcpPduType::CFG_param_network_information, pdu_seq_id,
+                                             receiver, param_id, transportProtocol) {
+        memcpy(getPath(), path.c_str(), path.size() + 1);
+    }
+
+#if defined(DEBUG) || defined(LOGGING)
+    /**
+     * Writes the Pdu in a human readable format to the given stream.
+     * @param os stream to write on.
+     */
+    virtual std::ostream &operator<<(std::ostream &os) {
+        DcpPduCfgParamNetworkInformation::operator<<(os);
+        if (isSizeCorrect()) {
+            os << " path=" << getPath();
+        }
+        return os;
+    }
+#endif
+
+    /**
+     * Check if the stream_size is large enough for a zero terminated path of at least one character.
+     * @return the path fits into stream_size and is zero terminated
+     */
+    virtual bool isSizeCorrect() {
+        return this->stream_size - PDU_LENGTH_INDICATOR_SIZE >= 9 && this->stream[this->stream_size - 1] == 0;
+    }
+
+    /**
+     * Returns the minimum stream_size, a path of one character.
+     * @return the minimum stream_size
+     */
+    virtual size_t getCorrectSize() {
+        return 9;
+    }
+};
+
 #endif //DCPLIB_DCPPDUCFGPARAMNETWORKINFORMATION_HPP
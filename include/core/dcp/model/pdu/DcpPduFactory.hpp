@@ -37,7 +37,18 @@
 #include <dcp/model/pdu/DcpPduStcRegister.hpp>
 #include <dcp/model/pdu/DcpPduStcRun.hpp>
 
-static DcpPdu *makeDcpPdu(unsigned char *stream, size_t stream_size) {
+#include <new>
+#include <type_traits>
+
+/**
+ * Selects the DcpPdu view class matching the type id of stream and lets construct create it.
+ * @param stream byte array containing the pdu, starting with the length indicator
+ * @param stream_size number of bytes in stream
+ * @param construct functor with a member template make<T>(stream, stream_size) returning the created view
+ * @return the created view
+ */
+template<typename Construct>
+static DcpPdu *decodeDcpPdu(unsigned char *stream, size_t stream_size, Construct &construct) {
     DcpPduType &type_id = *((DcpPduType * )(stream + PDU_LENGTH_INDICATOR_SIZE));
     switch (type_id) {
         case DcpPduType::STC_configure:
@@ -47,63 +58,66 @@ static DcpPdu *makeDcpPdu(unsigned char *stream, size_t stream_size) {
         case DcpPduType::STC_deregister:
         case DcpPduType::STC_send_outputs:
         case DcpPduType::STC_prepare:
-            return new DcpPduStc(stream, stream_size);
+            return construct.template make<DcpPduStc>(stream, stream_size);
         case DcpPduType::STC_run:
-            return new DcpPduStcRun(stream, stream_size);
+            return construct.template make<DcpPduStcRun>(stream, stream_size);
         case DcpPduType::INF_state:
-            return new DcpPduBasic(stream, stream_size);
+            return construct.template make<DcpPduBasic>(stream, stream_size);
         case DcpPduType::INF_error:
-            return new DcpPduBasic(stream, stream_size);
+            return construct.template make<DcpPduBasic>(stream, stream_size);
         case DcpPduType::INF_log:
-            return new DcpPduInfLog(stream, stream_size);
+            return construct.template make<DcpPduInfLog>(stream, stream_size);
         case DcpPduType::NTF_state_changed:
-            return new DcpPduNtfStateChanged(stream, stream_size);
+            return construct.template make<DcpPduNtfStateChanged>(stream, stream_size);
         case DcpPduType::NTF_log:
-            return new DcpPduNtfLog(stream, stream_size);
+            return construct.template make<DcpPduNtfLog>(stream, stream_size);
         case DcpPduType::STC_do_step:
-            return new DcpPduStcDoStep(stream, stream_size);
+            return construct.template make<DcpPduStcDoStep>(stream, stream_size);
         case DcpPduType::CFG_time_res:
-            return new DcpPduCfgTimeRes(stream, stream_size);
+            return construct.template make<DcpPduCfgTimeRes>(stream, stream_size);
         case DcpPduType::CFG_steps:
-            return new DcpPduCfgSteps(stream, stream_size);
+            return construct.template make<DcpPduCfgSteps>(stream, stream_size);
         case DcpPduType::CFG_scope:
-            return new DcpPduCfgScope(stream, stream_size);
+            return construct.template make<DcpPduCfgScope>(stream, stream_size);
         case DcpPduType::STC_register:
-            return new DcpPduStcRegister(stream, stream_size);
+            return construct.template make<DcpPduStcRegister>(stream, stream_size);
         case DcpPduType::CFG_input:
-            return new DcpPduCfgInput(stream, stream_size);
+            return construct.template make<DcpPduCfgInput>(stream, stream_size);
         case DcpPduType::CFG_output:
-            return new DcpPduCfgOutput(stream, stream_size);
+            return construct.template make<DcpPduCfgOutput>(stream, stream_size);
         case DcpPduType::CFG_clear:
-            return new DcpPduBasic(stream, stream_size);
+            return construct.template make<DcpPduBasic>(stream, stream_size);
         case DcpPduType::CFG_tunable_parameter:
-            return new DcpPduCfgTunableParameter(stream, stream_size);
+            return construct.template make<DcpPduCfgTunableParameter>(stream, stream_size);
         case DcpPduType::CFG_parameter:
-            return new DcpPduCfgParameter(stream, stream_size);
+            return construct.template make<DcpPduCfgParameter>(stream, stream_size);
         case DcpPduType::CFG_logging:
-            return new DcpPduCfgLogging(stream, stream_size);
+            return construct.template make<DcpPduCfgLogging>(stream, stream_size);
         case DcpPduType::DAT_input_output:
-            return new DcpPduDatInputOutput(stream, stream_size);
+            return construct.template make<DcpPduDatInputOutput>(stream, stream_size);
         case DcpPduType::DAT_parameter:
-            return new DcpPduDatParameter(stream, stream_size);
+            return construct.template make<DcpPduDatParameter>(stream, stream_size);
         case DcpPduType::RSP_ack:
-            return new DcpPduRspAck(stream, stream_size);
+            return construct.template make<DcpPduRspAck>(stream, stream_size);
         case DcpPduType::RSP_nack:
-            return new DcpPduRspNack(stream, stream_size);
+            return construct.template make<DcpPduRspNack>(stream, stream_size);
         case DcpPduType::RSP_error_ack:
-            return new DcpPduRspErrorAck(stream, stream_size);
+            return construct.template make<DcpPduRspErrorAck>(stream, stream_size);
         case DcpPduType::RSP_state_ack:
-            return new DcpPduRspStateAck(stream, stream_size);
+            return construct.template make<DcpPduRspStateAck>(stream, stream_size);
         case DcpPduType::RSP_log_ack:
-            return new DcpPduRspLogAck(stream, stream_size);
+            return construct.template make<DcpPduRspLogAck>(stream, stream_size);
         case DcpPduType::CFG_target_network_information: {
             DcpTransportProtocol &tp = *((DcpTransportProtocol * )(stream + 10));
             switch (tp) {
                 case DcpTransportProtocol::TCP_IPv4:
                 case DcpTransportProtocol::UDP_IPv4:
-                    return new DcpPduCfgNetworkInformationIPv4(stream, stream_size);
+                case DcpTransportProtocol::SHARED_MEMORY:
+                    return construct.template make<DcpPduCfgNetworkInformationIPv4>(stream, stream_size);
+                case DcpTransportProtocol::UNIX_DOMAIN:
+                    return construct.template make<DcpPduCfgNetworkInformationPath>(stream, stream_size);
                 default:
-                    return new DcpPduCfgNetworkInformation(stream, stream_size);
+                    return construct.template make<DcpPduCfgNetworkInformation>(stream, stream_size);
             }
 
         }
@@ -112,9 +126,12 @@ static DcpPdu *makeDcpPdu(unsigned char *stream, size_t stream_size) {
             switch (tp) {
                 case DcpTransportProtocol::TCP_IPv4:
                 case DcpTransportProtocol::UDP_IPv4:
-                    return new DcpPduCfgNetworkInformationIPv4(stream, stream_size);
+                case DcpTransportProtocol::SHARED_MEMORY:
+                    return construct.template make<DcpPduCfgNetworkInformationIPv4>(stream, stream_size);
+                case DcpTransportProtocol::UNIX_DOMAIN:
+                    return construct.template make<DcpPduCfgNetworkInformationPath>(stream, stream_size);
                 default:
-                    return new DcpPduCfgNetworkInformation(stream, stream_size);
+                    return construct.template make<DcpPduCfgNetworkInformation>(stream, stream_size);
             }
 
         }
@@ -123,14 +140,89 @@ static DcpPdu *makeDcpPdu(unsigned char *stream, size_t stream_size) {
             switch (tp) {
                 case DcpTransportProtocol::TCP_IPv4:
                 case DcpTransportProtocol::UDP_IPv4:
-                    return new DcpPduCfgParamNetworkInformationIPv4(stream, stream_size);
+                case DcpTransportProtocol::SHARED_MEMORY:
+                    return construct.template make<DcpPduCfgParamNetworkInformationIPv4>(stream, stream_size);
+                case DcpTransportProtocol::UNIX_DOMAIN:
+                    return construct.template make<DcpPduCfgParamNetworkInformationPath>(stream, stream_size);
                 default:
-                    return new DcpPduCfgNetworkInformation(stream, stream_size);
+                    return construct.template make<DcpPduCfgNetworkInformation>(stream, stream_size);
             }
 
         }
     }
-    return new DcpPdu(stream, stream_size);
+    return construct.template make<DcpPdu>(stream, stream_size);
 }
 
+struct DcpPduHeapConstruct {
+    template<typename T>
+    DcpPdu *make(unsigned char *stream, size_t stream_size) {
+        DcpPdu::countAllocation();
+        return new T(stream, stream_size);
+    }
+};
+
+/**
+ * Creates a heap allocated DcpPdu view for stream. The caller has to delete it.
+ * For the receive path use DcpPduSlot instead, which does not allocate.
+ */
+static DcpPdu *makeDcpPdu(unsigned char *stream, size_t stream_size) {
+    DcpPduHeapConstruct construct;
+    return decodeDcpPdu(stream, stream_size, construct);
+}
+
+/**
+ * Storage for exactly one DcpPdu view. The view matching the type id is constructed
+ * in place, so decoding a received pdu does not allocate any memory.
+ * The slot does not own the stream and is meant to live on the stack of a receive handler.
+ */
+class DcpPduSlot {
+public:
+    DcpPduSlot() : pdu(nullptr) {}
+
+    ~DcpPduSlot() {
+        clear();
+    }
+
+    DcpPduSlot(const DcpPduSlot &) = delete;
+
+    DcpPduSlot &operator=(const DcpPduSlot &) = delete;
+
+    /**
+     * Constructs the DcpPdu view for stream in this slot. A previously emplaced view is destroyed.
+     * @param stream byte array containing the pdu, starting with the length indicator
+     * @param stream_size number of bytes in stream
+     * @return the typed view, valid until the next emplace or the destruction of the slot
+     */
+    DcpPdu &emplace(unsigned char *stream, size_t stream_size) {
+        clear();
+        PlacementConstruct construct = {&storage};
+        pdu = decodeDcpPdu(stream, stream_size, construct);
+        return *pdu;
+    }
+
+    void clear() {
+        if (pdu != nullptr) {
+            pdu->~DcpPdu();
+            pdu = nullptr;
+        }
+    }
+
+private:
+    typedef std::aligned_storage<sizeof(DcpPdu), alignof(DcpPdu)>::type Storage;
+
+    struct PlacementConstruct {
+        Storage *storage;
+
+        template<typename T>
+        DcpPdu *make(unsigned char *stream, size_t stream_size) {
+            static_assert(sizeof(T) <= sizeof(Storage) && alignof(T) <= alignof(Storage),
+                          "DcpPdu views must not add data members");
+            return new(storage) T(stream, stream_size);
+        }
+    };
+
+    Storage storage;
+    DcpPdu *pdu;
+};
+
 #endif //DCPLIB_DCPPDUFACTORY_HPP
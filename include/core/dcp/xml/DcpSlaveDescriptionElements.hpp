@@ -292,11 +292,21 @@ struct TransportProtocols_t {
     std::shared_ptr<USB_t> USB;
     std::shared_ptr<Bluetooth_t> Bluetooth;
     std::shared_ptr<Ethernet_t> TCP_IPv4;
+    /**
+     * Ports of the SHARED_MEMORY transport protocol. Not part of the DCP slave description schema,
+     * so it is neither read from nor written to xml and has to be set by the slave itself.
+     */
+    std::shared_ptr<Ethernet_t> SharedMemory;
+    /**
+     * Support of the UNIX_DOMAIN transport protocol. Like SharedMemory not part of the schema.
+     */
+    bool UnixDomain;
 };
 
 static TransportProtocols_t make_TransportProtocols() {
     return {std::shared_ptr<Ethernet_t>(nullptr), false, std::shared_ptr<USB_t>(nullptr),
-            std::shared_ptr<Bluetooth_t>(nullptr), std::shared_ptr<Ethernet_t>(nullptr)};
+            std::shared_ptr<Bluetooth_t>(nullptr), std::shared_ptr<Ethernet_t>(nullptr),
+            std::shared_ptr<Ethernet_t>(nullptr), false};
 }
 
 struct CapabilityFlags_t {
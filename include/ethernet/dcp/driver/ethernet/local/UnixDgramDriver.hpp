@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_UNIXDGRAMDRIVER_H
+#define DCPLIB_UNIXDGRAMDRIVER_H
+
+#ifndef ASIO_STANDALONE
+#define ASIO_STANDALONE
+#endif
+
+#include <dcp/driver/ethernet/local/helper/LocalHelper.hpp>
+
+#include <dcp/driver/DcpDriver.hpp>
+
+/**
+ * DcpDriver for masters and slaves on the same host, using unix domain datagram sockets.
+ * Works like the UdpDriver, but endpoints are socket paths instead of host and port, which saves
+ * the IP stack on every PDU. The network information of the transport protocol UNIX_DOMAIN is
+ * the zero terminated socket path.
+ * Not available on platforms without unix domain sockets.
+ */
+class UnixDgramDriver : public Logable {
+public:
+    /**
+     * @param path Path of the main socket of this driver
+     */
+    UnixDgramDriver(std::string path) : mainPath(path), timer(io_service) {}
+
+    ~UnixDgramDriver() {}
+
+    DcpDriver getDcpDriver() {
+        return {[this](DcpPdu &msg) { this->send(msg); },
+                [this](dcpId_t dcpId, uint8_t *info) {
+                    otherSlaves[dcpId] = asio::local::datagram_protocol::endpoint((const char *) info);
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioIn.emplace(dataId, getSocket((const char *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioOut[dataId] = asio::local::datagram_protocol::endpoint((const char *) info);
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramIn.emplace(paramId, getSocket((const char *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramOut[paramId] = asio::local::datagram_protocol::endpoint((const char *) info);
+                },
+                std::bind(&UnixDgramDriver::startReceiving, this),
+                [this](dcpId_t) {/*nothing to do for connectionless UNIX_DOMAIN*/ },
+                [this](dcpId_t) {/*nothing to do for connectionless UNIX_DOMAIN*/ },
+                [this](DcpManager manager) {
+                    this->dcpManager = manager;
+                },
+
+                [this](const LogManager &logManager) {
+                    setLogManager(logManager);
+                },
+                std::bind(&UnixDgramDriver::registerSuccessfull, this),
+                std::bind(&UnixDgramDriver::openPorts, this),
+                [this]() {/*nothing to do for connectionless UNIX_DOMAIN*/ },
+                std::bind(&UnixDgramDriver::closeConfiguredPorts, this),
+                [this]() {/*nothing to do for connectionless UNIX_DOMAIN*/ },
+                std::bind(&UnixDgramDriver::stopReceiving, this),
+                nullptr,
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    armTimer(deadline, std::move(callback));
+                }
+        };
+    }
+
+private:
+
+    asio::io_service io_service;
+
+    DcpManager dcpManager;
+    std::string mainPath;
+    asio::steady_timer timer;
+
+    asio::local::datagram_protocol::endpoint masterEndpoint;
+    std::shared_ptr<LocalSocket> mainSocket;
+
+    std::map<dcpId_t, asio::local::datagram_protocol::endpoint> otherSlaves;
+    std::map<dataId_t, asio::local::datagram_protocol::endpoint> ioOut;
+    std::map<dataId_t, std::shared_ptr<LocalSocket>> ioIn;
+    std::map<paramId_t, std::shared_ptr<LocalSocket>> paramIn;
+    std::map<paramId_t, asio::local::datagram_protocol::endpoint> paramOut;
+
+    inline std::shared_ptr<LocalSocket> getSocket(const char *path) {
+        asio::local::datagram_protocol::endpoint endpoint(path);
+        if (mainSocket->getEndpoint() == endpoint) {
+            return mainSocket;
+        }
+        for (const auto &it : ioIn) {
+            if (it.second->getEndpoint() == endpoint) {
+                return it.second;
+            }
+        }
+        for (const auto &it : paramIn) {
+            if (it.second->getEndpoint() == endpoint) {
+                return it.second;
+            }
+        }
+        return std::make_shared<LocalSocket>(io_service, endpoint, dcpManager, logManager);
+    }
+
+    void send(DcpPdu &msg) {
+        switch (msg.getTypeId()) {
+            case DcpPduType::DAT_input_output: {
+                DcpPduDatInputOutput &data = static_cast<DcpPduDatInputOutput &>(msg);
+                mainSocket->send(msg, ioOut[data.getDataId()]);
+                break;
+            }
+            case DcpPduType::DAT_parameter: {
+                DcpPduDatParameter &param = static_cast<DcpPduDatParameter &>(msg);
+                mainSocket->send(msg, paramOut[param.getParamId()]);
+                break;
+            }
+            case DcpPduType::NTF_state_changed:
+            case DcpPduType::NTF_log: {
+                mainSocket->send(msg, masterEndpoint);
+                break;
+            }
+            case DcpPduType::RSP_ack:
+            case DcpPduType::RSP_nack:
+            case DcpPduType::RSP_state_ack:
+            case DcpPduType::RSP_error_ack:
+            case DcpPduType::RSP_log_ack: {
+                mainSocket->send(msg, mainSocket->getLastAccess());
+                break;
+            }
+            default: {
+                DcpPduBasic &basic = static_cast<DcpPduBasic &>(msg);
+                mainSocket->send(msg, otherSlaves[basic.getReceiver()]);
+                break;
+            }
+        }
+    }
+
+    void startReceiving() {
+        for (auto &pos: ioIn) {
+            pos.second->setLogManager(logManager);
+        }
+        for (auto &pos: paramIn) {
+            pos.second->setLogManager(logManager);
+        }
+        mainSocket = std::make_shared<LocalSocket>(io_service, asio::local::datagram_protocol::endpoint(mainPath),
+                                                   dcpManager, logManager);
+        mainSocket->start();
+        asio::io_service::work work(io_service);
+        io_service.run();
+    }
+
+    void stopReceiving() {
+        io_service.stop();
+    }
+
+    void armTimer(std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+        io_service.post([this, deadline, callback] {
+            if (!callback) {
+                timer.cancel();
+                return;
+            }
+            timer.expires_at(deadline);
+            timer.async_wait([callback](const std::error_code &error) {
+                if (!error) {
+                    callback();
+                }
+            });
+        });
+    }
+
+    void registerSuccessfull() {
+        masterEndpoint = mainSocket->getLastAccess();
+#if defined(DEBUG)
+        Log(NEW_MASTER_ENDPOINT, Local::protocolName,
+            to_string(masterEndpoint));
+#endif
+    }
+
+    void openPorts() {
+        for (auto &pos: ioIn) {
+            pos.second->start();
+        }
+        for (auto &pos: paramIn) {
+            pos.second->start();
+        }
+    }
+
+    void closeConfiguredPorts() {
+        for (auto &pos: ioIn) {
+            pos.second->close();
+        }
+        ioIn.clear();
+        for (auto &pos: paramIn) {
+            pos.second->close();
+        }
+        paramIn.clear();
+    }
+};
+
+#endif //DCPLIB_UNIXDGRAMDRIVER_H
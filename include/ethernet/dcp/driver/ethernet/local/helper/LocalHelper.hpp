@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_LOCALHELPER_H
+#define DCPLIB_LOCALHELPER_H
+
+#include <asio.hpp>
+#include <dcp/logic/Logable.hpp>
+#include <dcp/driver/ethernet/ErrorCodes.hpp>
+#include <dcp/logic/DcpManager.hpp>
+#include <dcp/model/pdu/DcpPduFactory.hpp>
+
+#include <cstdio>
+
+namespace Local {
+    static std::string protocolName = "UNIX_DOMAIN";
+}
+
+static std::string to_string(const asio::local::datagram_protocol::endpoint &remote_endpoint) {
+    return remote_endpoint.path();
+}
+
+/**
+ * Unix domain datagram socket bound to a path. Counterpart of the UDP Socket.
+ * The socket file is removed before binding and after closing.
+ * Sending never blocks: like a UDP datagram, a PDU for a missing or congested receiver is dropped.
+ */
+class LocalSocket : public Logable, public std::enable_shared_from_this<LocalSocket> {
+public:
+    LocalSocket(asio::io_service &ios, asio::local::datagram_protocol::endpoint endpoint, DcpManager &dcpManager,
+                LogManager &_logManager) : io_service(ios), endpoint(endpoint), dcpManager(dcpManager),
+                                           pool(slotLength), started(false) {
+        setLogManager(_logManager);
+    }
+
+    ~LocalSocket() {
+        if (started) {
+            std::remove(endpoint.path().c_str());
+        }
+#if defined(DEBUG)
+        Log(SOCKET_CLOSED, Local::protocolName, to_string(endpoint));
+#endif
+    }
+
+    void send(DcpPdu &msg, const asio::local::datagram_protocol::endpoint &endpoint) {
+#if defined(DEBUG)
+        Log(PDU_SEND, msg.to_string());
+#endif
+        std::error_code error;
+        socket->send_to(asio::buffer(msg.serializePdu(), msg.getPduSize()), endpoint, 0, error);
+        if (error && error != asio::error::would_block && error != asio::error::connection_refused
+            && error != std::errc::no_such_file_or_directory && error != asio::error::message_size) {
+#if defined(DEBUG) || defined(LOGGING)
+            Log(NETWORK_PROBLEM, Local::protocolName, error.message());
+#endif
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+        }
+    }
+
+    void handle_receive(const std::error_code &error, std::size_t bytes_transferred) {
+        if (asio::error::connection_reset == error || asio::error::operation_aborted == error ||
+            asio::error::eof == error) {
+            //Socket is closed => stop receiving
+            return;
+        }
+
+        if (error) {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+#if defined(DEBUG) || defined(LOGGING)
+            Log(NETWORK_PROBLEM, Local::protocolName, error.message());
+#endif
+            return;
+        }
+
+        DcpPduSlot slot;
+        DcpPdu &pdu = slot.emplace(buffer.data(), bytes_transferred);
+
+#if defined(DEBUG)
+        Log(PDU_RECEIVED, pdu.to_string());
+#endif
+        if (dcpManager.receiveBuffer) {
+            dcpManager.receiveBuffer(pdu, buffer);
+        } else {
+            dcpManager.receive(pdu);
+        }
+        setup_receive();
+    }
+
+    void setup_receive() {
+        //a buffer still referenced by the manager is left to it
+        if (buffer.useCount() != 1) {
+            buffer = pool.acquire();
+        }
+        socket->async_receive_from(asio::buffer(buffer.data() + 4, maxLength), lastAccess,
+                                   std::bind(&LocalSocket::handle_receive, shared_from_this(),
+                                             std::placeholders::_1,
+                                             std::placeholders::_2));
+    }
+
+    const asio::local::datagram_protocol::endpoint &getLastAccess() const {
+        return lastAccess;
+    }
+
+    void start() {
+        if (!started) {
+            //a socket file left behind by a previous run would make bind fail
+            std::remove(endpoint.path().c_str());
+            socket = std::unique_ptr<asio::local::datagram_protocol::socket>(
+                    new asio::local::datagram_protocol::socket(io_service, endpoint));
+            socket->non_blocking(true);
+            setup_receive();
+#if defined(DEBUG)
+            Log(NEW_SOCKET, Local::protocolName, to_string(endpoint));
+#endif
+            started = true;
+        }
+    }
+
+    void close() {
+        //one in asio queue, one existing in driver
+        if (shared_from_this().use_count() == 3) {
+            if (started && socket != nullptr) {
+                socket->close();
+                std::remove(endpoint.path().c_str());
+                started = false;
+            }
+        }
+    }
+
+    const asio::local::datagram_protocol::endpoint &getEndpoint() const {
+        return endpoint;
+    }
+
+private:
+    asio::io_service &io_service;
+    asio::local::datagram_protocol::endpoint endpoint;
+    std::unique_ptr<asio::local::datagram_protocol::socket> socket;
+    DcpManager dcpManager;
+    asio::local::datagram_protocol::endpoint lastAccess;
+    enum {
+        maxLength = 1024,
+        //length indicator and datagram
+        slotLength = maxLength + 4
+    };
+    BufferPool pool;
+    PooledBuffer buffer;
+    bool started;
+};
+
+#endif //DCPLIB_LOCALHELPER_H
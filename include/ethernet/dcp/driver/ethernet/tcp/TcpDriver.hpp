@@ -23,7 +23,7 @@
 class TcpDriver : public Logable {
 public:
 
-    TcpDriver(std::string host, uint16_t port) : mainPort(port), mainHost(host) {}
+    TcpDriver(std::string host, uint16_t port) : mainPort(port), mainHost(host), timer(io_service) {}
 
     ~TcpDriver() {
         closeConfiguredPorts();
@@ -64,6 +64,11 @@ public:
                 std::bind(&TcpDriver::connectToConfiguredPorts, this),
                 std::bind(&TcpDriver::closeConfiguredPorts, this),
                 std::bind(&TcpDriver::disconnect, this),
+                nullptr,
+                nullptr,
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    armTimer(deadline, std::move(callback));
+                }
         };
     }
 
@@ -77,6 +82,7 @@ private:
 
     std::shared_ptr<Server> mainServer;
     size_t mainSession;
+    asio::steady_timer timer;
 
     std::map<dataId_t, std::shared_ptr<Server>> ioServers;
     std::map<paramId_t, std::shared_ptr<Server>> parameterServers;
@@ -226,6 +232,21 @@ private:
         }
     }
 
+    void armTimer(std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+        io_service.post([this, deadline, callback] {
+            if (!callback) {
+                timer.cancel();
+                return;
+            }
+            timer.expires_at(deadline);
+            timer.async_wait([callback](const std::error_code &error) {
+                if (!error) {
+                    callback();
+                }
+            });
+        });
+    }
+
     void connectToSlave(dcpId_t dcpId) {
         otherSlaves[dcpId]->start();
     }
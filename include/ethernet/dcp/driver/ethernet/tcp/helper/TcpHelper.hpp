@@ -44,13 +44,13 @@ public:
 class Session : public Logable, public std::enable_shared_from_this<Session> {
 public:
     Session(asio::io_service &ios, DcpManager &manager, std::shared_ptr<SessionManager> _sessionManager, size_t cId)
-            : dcpManager(manager), sessionManager(_sessionManager), id(cId) {
+            : id(cId), pool(maxLength), dcpManager(manager), sessionManager(_sessionManager) {
         this->socket = std::make_shared<asio::ip::tcp::socket>(ios);
         this->client = nullptr;
     }
 
     Session(std::shared_ptr<asio::ip::tcp::socket> socket, DcpManager &manager, std::shared_ptr<IClient> client)
-            : dcpManager(manager), id(0) {
+            : id(0), pool(maxLength), dcpManager(manager) {
         this->socket = socket;
         this->sessionManager = nullptr;
         this->client = client;
@@ -67,8 +67,12 @@ public:
     }
 
     void prepareRead() {
+        //a buffer still referenced by the manager is left to it
+        if (buffer.useCount() != 1) {
+            buffer = pool.acquire();
+        }
         asio::async_read(*socket,
-                         asio::buffer(data, maxLength),
+                         asio::buffer(buffer.data(), maxLength),
                          std::bind(&Session::completion_condition, this,
                                    std::placeholders::_1,
                                    std::placeholders::_2),
@@ -90,7 +94,7 @@ public:
             return 0;
         }
         if (!error && bytes_transferred >= 4) {
-            return (*((uint32_t *) data) + 4) - bytes_transferred;
+            return (*((uint32_t *) buffer.data()) + 4) - bytes_transferred;
         }
         return 4 - bytes_transferred;
     }
@@ -103,12 +107,16 @@ public:
             if (sessionManager != nullptr) {
                 sessionManager->setLastSessionAccess(id);
             }
-            DcpPdu *pdu = makeDcpPdu(data, bytes_transferred - 4);
+            DcpPduSlot slot;
+            DcpPdu &pdu = slot.emplace(buffer.data(), bytes_transferred - 4);
 #if defined(DEBUG)
-            Log(PDU_RECEIVED, pdu->to_string());
+            Log(PDU_RECEIVED, pdu.to_string());
 #endif
-            dcpManager.receive(*pdu);
-            delete pdu;
+            if (dcpManager.receiveBuffer) {
+                dcpManager.receiveBuffer(pdu, buffer);
+            } else {
+                dcpManager.receive(pdu);
+            }
 
             prepareRead();
 
@@ -161,7 +169,8 @@ private:
         maxLength = 1024
     };
     size_t id;
-    uint8_t data[maxLength];
+    BufferPool pool;
+    PooledBuffer buffer;
     DcpManager &dcpManager;
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<IClient> client;
@@ -18,12 +18,39 @@
 
 #include <dcp/driver/DcpDriver.hpp>
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 class UdpDriver : public Logable {
 public:
-    UdpDriver(std::string host, uint16_t port) : mainPort(port), mainHost(host) {}
+    UdpDriver(std::string host, uint16_t port) : mainPort(port), mainHost(host), batchSize(1), ringDepth(1),
+                                                 receiveThreads(1), controlStrand(io_service), timer(io_service) {}
 
     ~UdpDriver() {}
 
+    /**
+     * Enables batched receiving with recvmmsg on all sockets of this driver (Linux only).
+     * Must be called before the driver is started.
+     * @param batchSize maximum number of datagrams read by one system call. 1 disables batching.
+     * @param ringDepth number of receive buffers per socket, i. e. the maximum number of datagrams drained per wakeup.
+     */
+    void setReceiveBatching(size_t batchSize, size_t ringDepth) {
+        this->batchSize = batchSize;
+        this->ringDepth = ringDepth;
+    }
+
+    /**
+     * Sets the number of threads which handle received PDUs. Each socket is served by one thread at a time,
+     * so the PDUs of one data id keep their order, while PDUs arriving on different sockets, e.g. from
+     * different sources, are handled in parallel. The main socket and the timer share one strand.
+     * Must be called before the driver is started.
+     * @param threads number of threads, including the one calling startReceiving
+     */
+    void setReceiveThreads(size_t threads) {
+        receiveThreads = threads > 0 ? threads : 1;
+    }
+
     DcpDriver getDcpDriver() {
         return {[this](DcpPdu &msg) { this->send(msg); },
                 [this](dcpId_t dcpId, uint8_t *info) {
@@ -56,7 +83,11 @@ public:
                 [this]() {/*nothing to do for connectionless UDP_IPv4*/ },
                 std::bind(&UdpDriver::closeConfiguredPorts, this),
                 [this]() {/*nothing to do for connectionless UDP_IPv4*/ },
-                std::bind(&UdpDriver::stopReceiving, this)
+                std::bind(&UdpDriver::stopReceiving, this),
+                [this](std::vector<DcpPdu *> &msgs) { this->sendBatch(msgs); },
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    armTimer(deadline, std::move(callback));
+                }
         };
     }
 
@@ -67,6 +98,12 @@ private:
     DcpManager dcpManager;
     uint16_t mainPort;
     std::string mainHost;
+    size_t batchSize;
+    size_t ringDepth;
+    size_t receiveThreads;
+    //serializes the main socket, which receives all control PDUs, and the timer
+    asio::io_service::strand controlStrand;
+    asio::steady_timer timer;
 
     asio::ip::udp::endpoint masterEndpoint;
     std::shared_ptr<Socket> mainSocket;
@@ -94,10 +131,27 @@ private:
                 return it.second;
             }
         }
-        return std::make_shared<Socket>(io_service, endpoint, dcpManager, logManager);
+        std::shared_ptr<Socket> socket = std::make_shared<Socket>(io_service, endpoint, dcpManager, logManager);
+        socket->setBatching(batchSize, ringDepth);
+        return socket;
     }
 
     void send(DcpPdu &msg) {
+        mainSocket->send(msg, getEndpoint(msg));
+    }
+
+    void sendBatch(std::vector<DcpPdu *> &msgs) {
+        asio::ip::udp::endpoint endpoints[Socket::maxSendBatch];
+        for (size_t done = 0; done < msgs.size(); done += Socket::maxSendBatch) {
+            size_t n = msgs.size() - done < Socket::maxSendBatch ? msgs.size() - done : Socket::maxSendBatch;
+            for (size_t i = 0; i < n; i++) {
+                endpoints[i] = getEndpoint(*msgs[done + i]);
+            }
+            mainSocket->send(msgs.data() + done, endpoints, n);
+        }
+    }
+
+    asio::ip::udp::endpoint getEndpoint(DcpPdu &msg) {
         asio::ip::udp::endpoint endpoint;
         switch (msg.getTypeId()) {
             case DcpPduType::DAT_input_output: {
@@ -129,7 +183,7 @@ private:
                 break;
             }
         }
-        mainSocket->send(msg, endpoint);
+        return endpoint;
     }
 
     void setSlaveNetworkInformation(dcpId_t dcpId, port_t port, ip_address_t ip) {
@@ -159,16 +213,39 @@ private:
         for (auto &pos: paramIn) {
             pos.second->setLogManager(logManager);
         }
-        mainSocket = std::make_shared<Socket>(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::from_string(mainHost), mainPort), dcpManager, logManager);
+        mainSocket = std::make_shared<Socket>(io_service, controlStrand, asio::ip::udp::endpoint(asio::ip::address_v4::from_string(mainHost), mainPort), dcpManager, logManager);
+        mainSocket->setBatching(batchSize, ringDepth);
         mainSocket->start();
         asio::io_service::work work(io_service);
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < receiveThreads; i++) {
+            threads.emplace_back([this] { io_service.run(); });
+        }
         io_service.run();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
     }
 
     void stopReceiving() {
         io_service.stop();
     }
 
+    void armTimer(std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+        controlStrand.post([this, deadline, callback] {
+            if (!callback) {
+                timer.cancel();
+                return;
+            }
+            timer.expires_at(deadline);
+            timer.async_wait(controlStrand.wrap([callback](const std::error_code &error) {
+                if (!error) {
+                    callback();
+                }
+            }));
+        });
+    }
+
     void registerSuccessfull() {
         masterEndpoint = mainSocket->getLastAccess();
 #if defined(DEBUG)
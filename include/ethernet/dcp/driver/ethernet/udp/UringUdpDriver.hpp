@@ -0,0 +1,630 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_URINGUDPDRIVER_H
+#define DCPLIB_URINGUDPDRIVER_H
+
+#include <dcp/driver/ethernet/udp/helper/UringHelper.hpp>
+#include <dcp/driver/ethernet/ErrorCodes.hpp>
+
+#include <dcp/driver/DcpDriver.hpp>
+#include <dcp/logic/Logable.hpp>
+#include <dcp/model/pdu/DcpPduBasic.hpp>
+#include <dcp/model/pdu/DcpPduDatInputOutput.hpp>
+#include <dcp/model/pdu/DcpPduDatParameter.hpp>
+#include <dcp/model/pdu/DcpPduFactory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace UringUdp {
+    static std::string protocolName = "UDP_IPv4";
+}
+
+/**
+ * UDP_IPv4 DcpDriver for Linux 6.0 or newer which does its network I/O through io_uring instead of the asio reactor.
+ * Every socket has one multishot receive request, which delivers datagrams into receive buffers
+ * provided to the kernel up front, so a wakeup drains any number of datagrams without further system calls.
+ * PDUs are sent from preallocated slots through the submission queue; all PDUs of one sendBatch,
+ * e.g. the outputs of one step, are submitted with a single system call. With submission queue polling
+ * enabled, sending needs no system call at all.
+ * Can be used instead of UdpDriver without any other change.
+ */
+class UringUdpDriver : public Logable {
+public:
+    UringUdpDriver(std::string host, uint16_t port) : mainKey(key(inet_network(host.c_str()), port)), sqPollIdle(0),
+                                                      stopped(false), mainSocket(-1), timerGeneration(0),
+                                                      fallbackSends(0) {}
+
+    ~UringUdpDriver() {
+        for (std::unique_ptr<Socket> &socket : sockets) {
+            if (socket != nullptr && socket->fd >= 0) {
+                close(socket->fd);
+            }
+        }
+    }
+
+    /**
+     * Let a kernel thread poll the submission queue, so sending PDUs needs no system call.
+     * Only pays off if a core is left for the polling thread. Must be called before the driver is started.
+     * @param idleMilliseconds time without submissions after which the polling thread sleeps. 0 disables polling.
+     */
+    void setSubmissionQueuePolling(unsigned idleMilliseconds) {
+        sqPollIdle = idleMilliseconds;
+    }
+
+    /**
+     * @return Number of PDUs sent with a plain sendto, because no send slot was free or the PDU was too large
+     */
+    uint64_t getFallbackSends() const {
+        return fallbackSends;
+    }
+
+    DcpDriver getDcpDriver() {
+        return {[this](DcpPdu &msg) { this->send(msg); },
+                [this](dcpId_t dcpId, uint8_t *info) {
+                    otherSlaves[dcpId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioIn[dataId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioOut[dataId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramIn[paramId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramOut[paramId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                std::bind(&UringUdpDriver::startReceiving, this),
+                [this](dcpId_t) {/*nothing to do for connectionless UDP_IPv4*/ },
+                [this](dcpId_t) {/*nothing to do for connectionless UDP_IPv4*/ },
+                [this](DcpManager manager) {
+                    this->dcpManager = manager;
+                },
+                [this](const LogManager &logManager) {
+                    setLogManager(logManager);
+                },
+                std::bind(&UringUdpDriver::registerSuccessfull, this),
+                std::bind(&UringUdpDriver::openPorts, this),
+                [this]() {/*nothing to do for connectionless UDP_IPv4*/ },
+                std::bind(&UringUdpDriver::closeConfiguredPorts, this),
+                [this]() {/*nothing to do for connectionless UDP_IPv4*/ },
+                std::bind(&UringUdpDriver::stopReceiving, this),
+                [this](std::vector<DcpPdu *> &msgs) { this->sendBatch(msgs); },
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    armTimer(deadline, std::move(callback));
+                }
+        };
+    }
+
+private:
+    enum : uint64_t {
+        //the upper byte of the user data of a request tells its kind, the rest its socket, slot or generation
+        RECEIVE = 1, SEND = 2, TIMER = 3, WAKEUP = 4, CANCEL = 5, PROVIDE = 6,
+        KIND_SHIFT = 56,
+        INDEX_MASK = (1ULL << KIND_SHIFT) - 1,
+    };
+    enum : size_t {
+        maxLength = 1024,
+        maxSockets = 256,
+        numSendSlots = 1024,
+        numReceiveBuffers = 1024,
+        //io_uring_recvmsg_out, source address and datagram
+        receiveBufferSize = 2048,
+        sqEntries = 256,
+        cqEntries = 8192,
+    };
+    static const uint16_t bufferGroup = 0;
+
+    /**
+     * Memory of one request, which has to stay valid until the kernel completed it.
+     */
+    struct SendSlot {
+        msghdr msg;
+        iovec iov;
+        sockaddr_in address;
+        __kernel_timespec timeout;
+        uint8_t data[maxLength];
+    };
+
+    struct Socket {
+        int fd = -1;
+        uint64_t key = 0;
+        //template for the multishot receive, only namelen is read by the kernel
+        msghdr msg;
+        bool closing = false;
+    };
+
+    uint64_t mainKey;
+    unsigned sqPollIdle;
+    std::atomic_bool stopped;
+    DcpManager dcpManager;
+
+    internal::IoUring uring;
+    internal::ProvidedBuffers receiveBuffers;
+    //guards the submission queue and the free send slots
+    std::mutex mtxSubmit;
+    std::unique_ptr<SendSlot[]> slots;
+    std::vector<uint32_t> freeSlots;
+
+    //sockets are only added or removed with mtxSubmit held, the receive thread reads them without lock
+    std::unique_ptr<Socket> sockets[maxSockets];
+    int mainSocket;
+    std::map<uint64_t, size_t> openSockets;
+
+    std::map<dcpId_t, uint64_t> otherSlaves;
+    std::map<dataId_t, uint64_t> ioOut;
+    std::map<paramId_t, uint64_t> paramOut;
+    std::map<dataId_t, uint64_t> ioIn;
+    std::map<paramId_t, uint64_t> paramIn;
+    uint64_t masterKey = 0;
+    //source of the last PDU received on the main socket
+    std::atomic<uint64_t> lastAccess{0};
+
+    std::mutex mtxTimer;
+    uint64_t timerGeneration;
+    std::function<void()> timerCallback;
+
+    std::atomic<uint64_t> fallbackSends;
+
+    static uint64_t key(ip_address_t ip, port_t port) {
+        return ((uint64_t) ip << 16) | port;
+    }
+
+    static sockaddr_in toAddress(uint64_t key) {
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl((uint32_t) (key >> 16));
+        address.sin_port = htons((uint16_t) (key & 0xFFFF));
+        return address;
+    }
+
+    static uint64_t toKey(const sockaddr_in &address) {
+        return key(ntohl(address.sin_addr.s_addr), ntohs(address.sin_port));
+    }
+
+    static std::string to_string(uint64_t key) {
+        char str[32];
+        std::snprintf(str, sizeof(str), "%u.%u.%u.%u:%u", (unsigned) (key >> 40) & 0xFF,
+                      (unsigned) (key >> 32) & 0xFF, (unsigned) (key >> 24) & 0xFF, (unsigned) (key >> 16) & 0xFF,
+                      (unsigned) (key & 0xFFFF));
+        return str;
+    }
+
+    void reportProblem(const std::string &message) {
+#if defined(DEBUG) || defined(LOGGING)
+        Log(NETWORK_PROBLEM, UringUdp::protocolName, message);
+#endif
+        dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+    }
+
+    uint64_t getTarget(DcpPdu &msg) {
+        switch (msg.getTypeId()) {
+            case DcpPduType::DAT_input_output:
+                return ioOut[static_cast<DcpPduDatInputOutput &>(msg).getDataId()];
+            case DcpPduType::DAT_parameter:
+                return paramOut[static_cast<DcpPduDatParameter &>(msg).getParamId()];
+            case DcpPduType::NTF_state_changed:
+            case DcpPduType::NTF_log:
+                return masterKey;
+            case DcpPduType::RSP_ack:
+            case DcpPduType::RSP_nack:
+            case DcpPduType::RSP_state_ack:
+            case DcpPduType::RSP_error_ack:
+            case DcpPduType::RSP_log_ack:
+                return lastAccess.load(std::memory_order_relaxed);
+            default:
+                return otherSlaves[static_cast<DcpPduBasic &>(msg).getReceiver()];
+        }
+    }
+
+    void send(DcpPdu &msg) {
+        std::lock_guard<std::mutex> lock(mtxSubmit);
+        if (queueSend(msg) && uring.submit() < 0) {
+            reportProblem(std::string(strerror(errno)));
+        }
+    }
+
+    void sendBatch(std::vector<DcpPdu *> &msgs) {
+        std::lock_guard<std::mutex> lock(mtxSubmit);
+        bool queued = false;
+        for (DcpPdu *msg : msgs) {
+            queued |= queueSend(*msg);
+        }
+        if (queued && uring.submit() < 0) {
+            reportProblem(std::string(strerror(errno)));
+        }
+    }
+
+    /**
+     * Copies msg into a free send slot and queues it. Without free slot or submission queue entry
+     * msg is sent with a plain sendto instead.
+     * @return True if a request was queued
+     * @pre mtxSubmit is held
+     */
+    bool queueSend(DcpPdu &msg) {
+        if (mainSocket < 0) {
+            return false;
+        }
+#if defined(DEBUG)
+        Log(PDU_SEND, msg.to_string());
+#endif
+        sockaddr_in address = toAddress(getTarget(msg));
+        size_t size = msg.getPduSize();
+        io_uring_sqe *sqe = nullptr;
+        if (size <= maxLength && !freeSlots.empty()) {
+            sqe = nextSqe();
+        }
+        if (sqe == nullptr) {
+            fallbackSends++;
+            if (sendto(mainSocket, msg.serializePdu(), size, 0, (sockaddr *) &address, sizeof(address)) < 0) {
+                reportProblem(std::string(strerror(errno)));
+            }
+            return false;
+        }
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        SendSlot &slot = slots[index];
+        std::memcpy(slot.data, msg.serializePdu(), size);
+        slot.address = address;
+        slot.iov.iov_base = slot.data;
+        slot.iov.iov_len = size;
+        std::memset(&slot.msg, 0, sizeof(msghdr));
+        slot.msg.msg_name = &slot.address;
+        slot.msg.msg_namelen = sizeof(sockaddr_in);
+        slot.msg.msg_iov = &slot.iov;
+        slot.msg.msg_iovlen = 1;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = mainSocket;
+        sqe->addr = (uint64_t) (uintptr_t) &slot.msg;
+        sqe->len = 1;
+        sqe->user_data = (SEND << KIND_SHIFT) | index;
+        return true;
+    }
+
+    /**
+     * @return A free submission queue entry, flushing the queue once if it is full, or nullptr
+     * @pre mtxSubmit is held
+     */
+    io_uring_sqe *nextSqe() {
+        io_uring_sqe *sqe = uring.getSqe();
+        if (sqe == nullptr && uring.submit() == 0) {
+            sqe = uring.getSqe();
+        }
+        return sqe;
+    }
+
+    /**
+     * @pre mtxSubmit is held
+     */
+    void armReceive(size_t index) {
+        Socket &socket = *sockets[index];
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe == nullptr) {
+            reportProblem("submission queue full");
+            return;
+        }
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = socket.fd;
+        sqe->addr = (uint64_t) (uintptr_t) &socket.msg;
+        sqe->len = 1;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = bufferGroup;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->user_data = (RECEIVE << KIND_SHIFT) | index;
+    }
+
+    /**
+     * Opens a socket bound to key and starts receiving on it.
+     * @pre mtxSubmit is held
+     */
+    int openSocket(uint64_t key) {
+        size_t index = 0;
+        while (index < maxSockets && sockets[index] != nullptr) {
+            index++;
+        }
+        if (index == maxSockets) {
+            reportProblem("too many sockets");
+            return -1;
+        }
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address = toAddress(key);
+        if (fd < 0 || bind(fd, (sockaddr *) &address, sizeof(address)) < 0) {
+            reportProblem(std::string(strerror(errno)));
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        std::unique_ptr<Socket> socket(new Socket());
+        socket->fd = fd;
+        socket->key = key;
+        std::memset(&socket->msg, 0, sizeof(msghdr));
+        socket->msg.msg_namelen = sizeof(sockaddr_in);
+        sockets[index] = std::move(socket);
+        openSockets[key] = index;
+        armReceive(index);
+#if defined(DEBUG)
+        Log(NEW_SOCKET, UringUdp::protocolName, to_string(key));
+#endif
+        return fd;
+    }
+
+    /**
+     * Cancels the receive request of a socket. The socket is closed when its last completion arrives.
+     * @pre mtxSubmit is held
+     */
+    void closeSocket(size_t index) {
+        sockets[index]->closing = true;
+        openSockets.erase(sockets[index]->key);
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe == nullptr) {
+            return;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = (RECEIVE << KIND_SHIFT) | index;
+        sqe->user_data = CANCEL << KIND_SHIFT;
+    }
+
+    void startReceiving() {
+        {
+            std::lock_guard<std::mutex> lock(mtxSubmit);
+            if (!uring.isInitialized()) {
+                int result = uring.init(sqEntries, cqEntries, sqPollIdle);
+                if (result < 0) {
+                    reportProblem(std::string("io_uring: ") + strerror(-result));
+                    return;
+                }
+                receiveBuffers.init(bufferGroup, numReceiveBuffers, receiveBufferSize);
+                slots = std::unique_ptr<SendSlot[]>(new SendSlot[numSendSlots]);
+                for (uint32_t i = 0; i < numSendSlots; i++) {
+                    freeSlots.push_back(numSendSlots - 1 - i);
+                }
+            }
+            stopped = false;
+            receiveBuffers.provide(uring, PROVIDE << KIND_SHIFT);
+            if (mainSocket < 0) {
+                mainSocket = openSocket(mainKey);
+            }
+            if (mainSocket < 0 || uring.submit() < 0) {
+                return;
+            }
+        }
+        std::vector<uint32_t> completedSlots;
+        std::vector<std::pair<size_t, int>> endedReceives;
+        while (!stopped.load(std::memory_order_acquire)) {
+            int result = uring.wait();
+            if (result < 0) {
+                reportProblem(std::string("io_uring: ") + strerror(-result));
+                return;
+            }
+            bool received = false;
+            uring.reap([this, &completedSlots, &endedReceives, &received](const io_uring_cqe &cqe) {
+                switch (cqe.user_data >> KIND_SHIFT) {
+                    case RECEIVE:
+                        received |= handleReceive(cqe, endedReceives);
+                        break;
+                    case SEND:
+                        if (cqe.res < 0 && cqe.res != -ECONNREFUSED) {
+                            reportProblem(std::string(strerror(-cqe.res)));
+                        }
+                        completedSlots.push_back((uint32_t) (cqe.user_data & INDEX_MASK));
+                        break;
+                    case TIMER:
+                        completedSlots.push_back((uint32_t) (cqe.user_data & 0xFFFFFFFF));
+                        if (cqe.res == -ETIME) {
+                            fireTimer((cqe.user_data & INDEX_MASK) >> 32);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            });
+            if (completedSlots.empty() && !received && endedReceives.empty()) {
+                continue;
+            }
+            //one lock and at most one system call per batch of completions
+            std::lock_guard<std::mutex> lock(mtxSubmit);
+            freeSlots.insert(freeSlots.end(), completedSlots.begin(), completedSlots.end());
+            completedSlots.clear();
+            //buffers go back first, so that a receive stopped for lack of them can continue
+            receiveBuffers.provide(uring, PROVIDE << KIND_SHIFT);
+            for (const std::pair<size_t, int> &ended : endedReceives) {
+                restartReceive(ended.first, ended.second);
+            }
+            endedReceives.clear();
+            if (uring.submit() < 0) {
+                reportProblem(std::string(strerror(errno)));
+            }
+        }
+    }
+
+    /**
+     * Dispatches a received datagram and takes back its buffer.
+     * @param endedReceives collects sockets whose multishot receive ended, together with the result
+     * @return True if a buffer was used
+     */
+    bool handleReceive(const io_uring_cqe &cqe, std::vector<std::pair<size_t, int>> &endedReceives) {
+        size_t index = (size_t) (cqe.user_data & INDEX_MASK);
+        Socket &socket = *sockets[index];
+        bool usedBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        if (usedBuffer) {
+            uint16_t id = (uint16_t) (cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0 && !socket.closing) {
+                dispatch(socket, receiveBuffers.get(id));
+            }
+            receiveBuffers.add(id);
+        } else if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+            reportProblem(std::string(strerror(-cqe.res)));
+        }
+        if (!(cqe.flags & IORING_CQE_F_MORE)) {
+            endedReceives.emplace_back(index, cqe.res);
+        }
+        return usedBuffer;
+    }
+
+    /**
+     * Queues the receive of a socket again, or closes the socket if it is closing.
+     * @param result result of the last completion of the receive
+     * @pre mtxSubmit is held
+     */
+    void restartReceive(size_t index, int result) {
+        Socket &socket = *sockets[index];
+        if (socket.closing) {
+#if defined(DEBUG)
+            Log(SOCKET_CLOSED, UringUdp::protocolName, to_string(socket.key));
+#endif
+            close(socket.fd);
+            sockets[index].reset();
+            return;
+        }
+        if (result < 0 && result != -ENOBUFS) {
+            //e.g. a kernel without multishot receive, queuing it again would fail again
+            return;
+        }
+        armReceive(index);
+    }
+
+    void dispatch(Socket &socket, uint8_t *buffer) {
+        io_uring_recvmsg_out *out = (io_uring_recvmsg_out *) buffer;
+        if (out->flags & MSG_TRUNC) {
+            return;
+        }
+        uint8_t *name = buffer + sizeof(io_uring_recvmsg_out);
+        uint8_t *payload = name + socket.msg.msg_namelen + socket.msg.msg_controllen;
+        if (socket.fd == mainSocket && out->namelen >= sizeof(sockaddr_in)) {
+            lastAccess.store(toKey(*((sockaddr_in *) name)), std::memory_order_relaxed);
+        }
+        //the length indicator overwrites the end of the source address, which was read already
+        DcpPduSlot slot;
+        DcpPdu &pdu = slot.emplace(payload - 4, out->payloadlen);
+#if defined(DEBUG)
+        Log(PDU_RECEIVED, pdu.to_string());
+#endif
+        dcpManager.receive(pdu);
+    }
+
+    void stopReceiving() {
+        stopped = true;
+        std::lock_guard<std::mutex> lock(mtxSubmit);
+        if (!uring.isInitialized()) {
+            return;
+        }
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe != nullptr) {
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = WAKEUP << KIND_SHIFT;
+            uring.submit();
+        }
+    }
+
+    void armTimer(std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mtxTimer);
+            generation = ++timerGeneration;
+            timerCallback = std::move(callback);
+            if (!timerCallback) {
+                //an outdated timeout expires without effect
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mtxSubmit);
+        if (!uring.isInitialized() || freeSlots.empty()) {
+            return;
+        }
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe == nullptr) {
+            return;
+        }
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        SendSlot &slot = slots[index];
+        std::chrono::nanoseconds time = deadline.time_since_epoch();
+        slot.timeout.tv_sec = time.count() / 1000000000;
+        slot.timeout.tv_nsec = time.count() % 1000000000;
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->addr = (uint64_t) (uintptr_t) &slot.timeout;
+        sqe->len = 1;
+        sqe->timeout_flags = IORING_TIMEOUT_ABS;
+        sqe->user_data = (TIMER << KIND_SHIFT) | ((generation & 0xFFFFFF) << 32) | index;
+        uring.submit();
+    }
+
+    void fireTimer(uint64_t generation) {
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(mtxTimer);
+            if ((timerGeneration & 0xFFFFFF) != generation || !timerCallback) {
+                return;
+            }
+            callback = std::move(timerCallback);
+            timerCallback = nullptr;
+        }
+        callback();
+    }
+
+    void registerSuccessfull() {
+        masterKey = lastAccess.load(std::memory_order_relaxed);
+#if defined(DEBUG)
+        Log(NEW_MASTER_ENDPOINT, UringUdp::protocolName, to_string(masterKey));
+#endif
+    }
+
+    void openPorts() {
+        std::set<uint64_t> keys;
+        for (auto &pos : ioIn) {
+            keys.insert(pos.second);
+        }
+        for (auto &pos : paramIn) {
+            keys.insert(pos.second);
+        }
+        std::lock_guard<std::mutex> lock(mtxSubmit);
+        for (uint64_t key : keys) {
+            //the main socket also receives for its port if it is bound to 0.0.0.0
+            if (key == mainKey || (mainKey >> 16 == 0 && (mainKey & 0xFFFF) == (key & 0xFFFF))
+                || openSockets.count(key)) {
+                continue;
+            }
+            openSocket(key);
+        }
+        uring.submit();
+    }
+
+    void closeConfiguredPorts() {
+        {
+            std::lock_guard<std::mutex> lock(mtxSubmit);
+            for (size_t i = 0; i < maxSockets; i++) {
+                if (sockets[i] != nullptr && sockets[i]->fd != mainSocket && !sockets[i]->closing) {
+                    closeSocket(i);
+                }
+            }
+            if (uring.isInitialized()) {
+                uring.submit();
+            }
+        }
+        ioIn.clear();
+        paramIn.clear();
+    }
+};
+
+#endif //DCPLIB_URINGUDPDRIVER_H
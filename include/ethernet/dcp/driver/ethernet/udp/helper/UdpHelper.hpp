@@ -16,6 +16,13 @@
 #include <dcp/logic/DcpManager.hpp>
 #include <dcp/model/pdu/DcpPduFactory.hpp>
 
+#include <vector>
+#if defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
 namespace Udp {
     static std::string protocolName = "UDP_IPv4";
 }
@@ -26,11 +33,25 @@ static std::string to_string(const asio::ip::udp::endpoint &remote_endpoint) {
     return oss.str();
 }
 
+/**
+ * UDP socket bound to an endpoint. All receive handlers of a socket run on its strand, so PDUs of one
+ * socket are dispatched one after another and in arrival order, even if several threads run the io_service.
+ */
 class Socket : public Logable, public std::enable_shared_from_this<Socket> {
 public:
+    static const size_t maxSendBatch = 64;
 
     Socket(asio::io_service &ios, asio::ip::udp::endpoint endpoint, DcpManager &dcpManager, LogManager &_logManager) :
-            io_service(ios), endpoint(endpoint), dcpManager(dcpManager), started(false) {
+            Socket(ios, asio::io_service::strand(ios), endpoint, dcpManager, _logManager) {}
+
+    /**
+     * @param strand strand to run the receive handlers on, may be shared with other handlers which must not
+     * run concurrently to the ones of this socket
+     */
+    Socket(asio::io_service &ios, asio::io_service::strand strand, asio::ip::udp::endpoint endpoint,
+           DcpManager &dcpManager, LogManager &_logManager) :
+            io_service(ios), strand(strand), endpoint(endpoint), dcpManager(dcpManager), pool(slotLength),
+            started(false), batchSize(1), ringDepth(1) {
         setLogManager(_logManager);
     }
 
@@ -63,6 +84,60 @@ public:
         }
     }
 
+    /**
+     * Sends count PDUs, msgs[i] to endpoints[i], in the given order. On Linux they are passed
+     * to the kernel with sendmmsg in chunks of maxSendBatch, elsewhere they are sent one by one.
+     * Like a blocking send, it waits for space in the send buffer of the non-blocking socket.
+     */
+    void send(DcpPdu **msgs, asio::ip::udp::endpoint *endpoints, size_t count) {
+#if defined(__linux__)
+        mmsghdr hdrs[maxSendBatch];
+        iovec vecs[maxSendBatch];
+        size_t done = 0;
+        while (done < count) {
+            size_t n = count - done < maxSendBatch ? count - done : maxSendBatch;
+            for (size_t i = 0; i < n; i++) {
+#if defined(DEBUG)
+                Log(PDU_SEND, msgs[done + i]->to_string());
+#endif
+                vecs[i].iov_base = msgs[done + i]->serializePdu();
+                vecs[i].iov_len = msgs[done + i]->getPduSize();
+                std::memset(&hdrs[i], 0, sizeof(mmsghdr));
+                hdrs[i].msg_hdr.msg_name = endpoints[done + i].data();
+                hdrs[i].msg_hdr.msg_namelen = endpoints[done + i].size();
+                hdrs[i].msg_hdr.msg_iov = &vecs[i];
+                hdrs[i].msg_hdr.msg_iovlen = 1;
+            }
+            size_t sent = 0;
+            while (sent < n) {
+                int r = sendmmsg(socket->native_handle(), hdrs + sent, n - sent, 0);
+                if (r < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        pollfd writable = {socket->native_handle(), POLLOUT, 0};
+                        if (poll(&writable, 1, -1) >= 0 || errno == EINTR) {
+                            continue;
+                        }
+                    }
+#if defined(DEBUG) || defined(LOGGING)
+                    Log(NETWORK_PROBLEM, Udp::protocolName, std::string(strerror(errno)));
+#endif
+                    dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+                    return;
+                }
+                sent += r;
+            }
+            done += n;
+        }
+#else
+        for (size_t i = 0; i < count; i++) {
+            send(*msgs[i], endpoints[i]);
+        }
+#endif
+    }
+
     void handle_receive(const std::error_code &error, std::size_t bytes_transferred) {
         if (asio::error::connection_reset == error || asio::error::operation_aborted == error ||
             asio::error::eof == error) {
@@ -78,21 +153,46 @@ public:
             return;
         }
 
-        DcpPdu *pdu = makeDcpPdu(data, bytes_transferred);
+        DcpPduSlot slot;
+        DcpPdu &pdu = slot.emplace(buffer.data(), bytes_transferred);
 
 #if defined(DEBUG)
-        Log(PDU_RECEIVED, pdu->to_string());
+        Log(PDU_RECEIVED, pdu.to_string());
 #endif
-        dcpManager.receive(*pdu);
-        delete pdu;
+        dispatch(pdu, buffer);
         setup_receive();
     }
 
     void setup_receive() {
-        socket->async_receive_from(asio::buffer(data + 4, maxLength), lastAccess,
-                                   std::bind(&Socket::handle_receive, shared_from_this(),
-                                             std::placeholders::_1,
-                                             std::placeholders::_2));
+#if defined(__linux__)
+        if (batchSize > 1) {
+            socket->async_wait(asio::ip::udp::socket::wait_read,
+                               strand.wrap(std::bind(&Socket::handle_batch_receive, shared_from_this(),
+                                                     std::placeholders::_1)));
+            return;
+        }
+#endif
+        //a buffer still referenced by the manager is left to it
+        if (buffer.useCount() != 1) {
+            buffer = pool.acquire();
+        }
+        socket->async_receive_from(asio::buffer(buffer.data() + 4, maxLength), lastAccess,
+                                   strand.wrap(std::bind(&Socket::handle_receive, shared_from_this(),
+                                                         std::placeholders::_1,
+                                                         std::placeholders::_2)));
+    }
+
+    /**
+     * Enables batched receiving. On each wakeup up to ringDepth datagrams are drained from the
+     * socket with recvmmsg, reading at most batchSize datagrams per call. The received PDUs are
+     * dispatched in arrival order. Only available on Linux, elsewhere one datagram is read per wakeup.
+     * Must be called before start.
+     * @param batchSize maximum number of datagrams read by one recvmmsg call. 1 disables batching.
+     * @param ringDepth number of receive buffers. Values smaller than batchSize are raised to batchSize.
+     */
+    void setBatching(size_t batchSize, size_t ringDepth) {
+        this->batchSize = batchSize > 0 ? batchSize : 1;
+        this->ringDepth = ringDepth > this->batchSize ? ringDepth : this->batchSize;
     }
 
     const asio::ip::udp::endpoint &getLastAccess() const {
@@ -102,6 +202,11 @@ public:
     void start() {
         if(!started){
             socket = std::unique_ptr<asio::ip::udp::socket>(new asio::ip::udp::socket(io_service, endpoint));
+#if defined(__linux__)
+            if (batchSize > 1) {
+                setup_ring();
+            }
+#endif
             setup_receive();
 #if defined(DEBUG)
             Log(NEW_SOCKET, Udp::protocolName, to_string(endpoint));
@@ -125,16 +230,109 @@ public:
     }
 
 private:
+#if defined(__linux__)
+    void setup_ring() {
+        ring.resize(ringDepth);
+        ringSenders.assign(ringDepth, asio::ip::udp::endpoint());
+        ringVecs.resize(ringDepth);
+        ringMsgs.resize(ringDepth);
+        for (size_t i = 0; i < ringDepth; i++) {
+            ring[i] = pool.acquire();
+            ringVecs[i].iov_base = ring[i].data() + 4;
+            ringVecs[i].iov_len = maxLength;
+        }
+    }
+
+    void handle_batch_receive(const std::error_code &error) {
+        if (asio::error::operation_aborted == error) {
+            //Socket is closed => stop receiving
+            return;
+        }
+        if (error) {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+#if defined(DEBUG) || defined(LOGGING)
+            Log(NETWORK_PROBLEM, Udp::protocolName, error.message());
+#endif
+            return;
+        }
+
+        size_t received = 0;
+        while (received < ringDepth) {
+            size_t vlen = ringDepth - received < batchSize ? ringDepth - received : batchSize;
+            for (size_t i = received; i < received + vlen; i++) {
+                std::memset(&ringMsgs[i], 0, sizeof(mmsghdr));
+                ringMsgs[i].msg_hdr.msg_name = ringSenders[i].data();
+                ringMsgs[i].msg_hdr.msg_namelen = ringSenders[i].capacity();
+                ringMsgs[i].msg_hdr.msg_iov = &ringVecs[i];
+                ringMsgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            int n = recvmmsg(socket->native_handle(), &ringMsgs[received], vlen, MSG_DONTWAIT, nullptr);
+            if (n < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+#if defined(DEBUG) || defined(LOGGING)
+                    Log(NETWORK_PROBLEM, Udp::protocolName, std::string(strerror(errno)));
+#endif
+                }
+                break;
+            }
+            received += n;
+            if ((size_t) n < vlen) {
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < received; i++) {
+            ringSenders[i].resize(ringMsgs[i].msg_hdr.msg_namelen);
+            lastAccess = ringSenders[i];
+            DcpPduSlot slot;
+            DcpPdu &pdu = slot.emplace(ring[i].data(), ringMsgs[i].msg_len);
+#if defined(DEBUG)
+            Log(PDU_RECEIVED, pdu.to_string());
+#endif
+            dispatch(pdu, ring[i]);
+        }
+        for (size_t i = 0; i < received; i++) {
+            if (ring[i].useCount() != 1) {
+                ring[i] = pool.acquire();
+                ringVecs[i].iov_base = ring[i].data() + 4;
+            }
+        }
+        setup_receive();
+    }
+#endif
+
+    void dispatch(DcpPdu &pdu, const PooledBuffer &buffer) {
+        if (dcpManager.receiveBuffer) {
+            dcpManager.receiveBuffer(pdu, buffer);
+        } else {
+            dcpManager.receive(pdu);
+        }
+    }
+
     asio::io_service &io_service;
+    asio::io_service::strand strand;
     asio::ip::udp::endpoint endpoint;
     std::unique_ptr<asio::ip::udp::socket> socket;
     DcpManager dcpManager;
     asio::ip::udp::endpoint lastAccess;
     enum {
-        maxLength = 1024
+        maxLength = 1024,
+        //length indicator and datagram
+        slotLength = maxLength + 4
     };
-    uint8_t data[maxLength];
+    BufferPool pool;
+    PooledBuffer buffer;
     bool started;
+
+    size_t batchSize;
+    size_t ringDepth;
+#if defined(__linux__)
+    std::vector<PooledBuffer> ring;
+    std::vector<asio::ip::udp::endpoint> ringSenders;
+    std::vector<iovec> ringVecs;
+    std::vector<mmsghdr> ringMsgs;
+#endif
 };
 
 #endif //DCPLIB_UDPHELPER_H
\ No newline at end of file
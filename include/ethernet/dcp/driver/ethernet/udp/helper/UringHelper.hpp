@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_URINGHELPER_H
+#define DCPLIB_URINGHELPER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace internal {
+    /**
+     * Minimal io_uring instance on top of the raw system calls.
+     * The submission queue must only be used by one thread at a time, the completion queue only by one thread.
+     */
+    class IoUring {
+    public:
+        IoUring() : fd(-1), sqPoll(false), ringPtr(MAP_FAILED), ringSize(0), cqPtr(MAP_FAILED), cqSize(0),
+                    sqesPtr(MAP_FAILED), sqesSize(0), sqTailLocal(0), unsubmitted(0) {}
+
+        ~IoUring() {
+            if (sqesPtr != MAP_FAILED) {
+                munmap(sqesPtr, sqesSize);
+            }
+            if (cqPtr != MAP_FAILED && cqPtr != ringPtr) {
+                munmap(cqPtr, cqSize);
+            }
+            if (ringPtr != MAP_FAILED) {
+                munmap(ringPtr, ringSize);
+            }
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+
+        IoUring(const IoUring &) = delete;
+
+        IoUring &operator=(const IoUring &) = delete;
+
+        /**
+         * @param entries Size of the submission queue
+         * @param cqEntries Size of the completion queue
+         * @param sqPollIdle If not 0, a kernel thread polls the submission queue and sleeps after
+         * sqPollIdle milliseconds without submissions
+         * @return 0 or the negated errno of the failed call
+         */
+        int init(unsigned entries, unsigned cqEntries, unsigned sqPollIdle) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = cqEntries;
+            if (sqPollIdle > 0) {
+                params.flags |= IORING_SETUP_SQPOLL;
+                params.sq_thread_idle = sqPollIdle;
+            }
+            fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+            if (fd < 0) {
+                return -errno;
+            }
+            sqPoll = sqPollIdle > 0;
+            ringSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP) {
+                ringSize = cqSize > ringSize ? cqSize : ringSize;
+            }
+            ringPtr = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQ_RING);
+            if (ringPtr == MAP_FAILED) {
+                return -errno;
+            }
+            cqPtr = ringPtr;
+            if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+                cqPtr = mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_CQ_RING);
+                if (cqPtr == MAP_FAILED) {
+                    return -errno;
+                }
+            }
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqesPtr = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                           IORING_OFF_SQES);
+            if (sqesPtr == MAP_FAILED) {
+                return -errno;
+            }
+            uint8_t *sq = (uint8_t *) ringPtr;
+            sqHead = (unsigned *) (sq + params.sq_off.head);
+            sqTail = (unsigned *) (sq + params.sq_off.tail);
+            sqMask = *((unsigned *) (sq + params.sq_off.ring_mask));
+            sqEntries = params.sq_entries;
+            sqFlags = (unsigned *) (sq + params.sq_off.flags);
+            unsigned *array = (unsigned *) (sq + params.sq_off.array);
+            for (unsigned i = 0; i < sqEntries; i++) {
+                array[i] = i;
+            }
+            uint8_t *cq = (uint8_t *) cqPtr;
+            cqHead = (unsigned *) (cq + params.cq_off.head);
+            cqTail = (unsigned *) (cq + params.cq_off.tail);
+            cqMask = *((unsigned *) (cq + params.cq_off.ring_mask));
+            cqes = (io_uring_cqe *) (cq + params.cq_off.cqes);
+            sqes = (io_uring_sqe *) sqesPtr;
+            sqTailLocal = *sqTail;
+            return 0;
+        }
+
+        bool isInitialized() const {
+            return sqesPtr != MAP_FAILED;
+        }
+
+        /**
+         * @return A zeroed submission queue entry, or nullptr if the submission queue is full.
+         * The entry is passed to the kernel with the next submit.
+         */
+        io_uring_sqe *getSqe() {
+            unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            if (sqTailLocal - head >= sqEntries) {
+                return nullptr;
+            }
+            io_uring_sqe *sqe = &sqes[sqTailLocal & sqMask];
+            std::memset(sqe, 0, sizeof(io_uring_sqe));
+            sqTailLocal++;
+            unsubmitted++;
+            return sqe;
+        }
+
+        /**
+         * Passes all new entries to the kernel. With submission queue polling this needs no system call
+         * unless the polling thread went to sleep.
+         * @return 0 or the negated errno of the failed call
+         */
+        int submit() {
+            __atomic_store_n(sqTail, sqTailLocal, __ATOMIC_RELEASE);
+            if (sqPoll) {
+                unsubmitted = 0;
+                __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                if (__atomic_load_n(sqFlags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+                    return enter(0, 0, IORING_ENTER_SQ_WAKEUP);
+                }
+                return 0;
+            }
+            while (unsubmitted > 0) {
+                int submitted = enter(unsubmitted, 0, 0);
+                if (submitted < 0) {
+                    return submitted;
+                }
+                unsubmitted -= (unsigned) submitted;
+            }
+            return 0;
+        }
+
+        /**
+         * Blocks until at least one completion is available.
+         * @return 0 or the negated errno of the failed call
+         */
+        int wait() {
+            int result = enter(0, 1, IORING_ENTER_GETEVENTS);
+            return result < 0 ? result : 0;
+        }
+
+        /**
+         * Calls handler for every available completion and releases them afterwards.
+         * @return Number of handled completions
+         */
+        template<typename Handler>
+        unsigned reap(Handler handler) {
+            unsigned head = *cqHead;
+            unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            unsigned count = tail - head;
+            for (; head != tail; head++) {
+                handler(cqes[head & cqMask]);
+            }
+            __atomic_store_n(cqHead, tail, __ATOMIC_RELEASE);
+            return count;
+        }
+
+    private:
+        int fd;
+        bool sqPoll;
+        void *ringPtr;
+        size_t ringSize;
+        void *cqPtr;
+        size_t cqSize;
+        void *sqesPtr;
+        size_t sqesSize;
+
+        unsigned *sqHead;
+        unsigned *sqTail;
+        unsigned *sqFlags;
+        unsigned sqMask;
+        unsigned sqEntries;
+        io_uring_sqe *sqes;
+        unsigned sqTailLocal;
+        unsigned unsubmitted;
+
+        unsigned *cqHead;
+        unsigned *cqTail;
+        unsigned cqMask;
+        io_uring_cqe *cqes;
+
+        int enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+            while (true) {
+                int result = (int) syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+                if (result >= 0) {
+                    return result;
+                }
+                if (errno != EINTR) {
+                    return -errno;
+                }
+            }
+        }
+    };
+
+    /**
+     * Receive buffers provided to an IoUring as one buffer group. The kernel picks a free buffer for every
+     * received datagram, the owner gives it back with add once the datagram is processed.
+     * Given back buffers are provided again with the next submit after provide.
+     */
+    class ProvidedBuffers {
+    public:
+        ProvidedBuffers() : groupId(0), bufferSize(0) {}
+
+        ProvidedBuffers(const ProvidedBuffers &) = delete;
+
+        ProvidedBuffers &operator=(const ProvidedBuffers &) = delete;
+
+        void init(uint16_t groupId, uint16_t count, size_t bufferSize) {
+            this->groupId = groupId;
+            this->bufferSize = bufferSize;
+            storage = std::unique_ptr<uint8_t[]>(new uint8_t[count * bufferSize]);
+            returned.clear();
+            for (uint16_t id = 0; id < count; id++) {
+                returned.push_back(id);
+            }
+        }
+
+        uint8_t *get(uint16_t id) {
+            return storage.get() + id * bufferSize;
+        }
+
+        size_t getBufferSize() const {
+            return bufferSize;
+        }
+
+        uint16_t getGroupId() const {
+            return groupId;
+        }
+
+        /**
+         * Marks buffer id as free again.
+         */
+        void add(uint16_t id) {
+            returned.push_back(id);
+        }
+
+        /**
+         * Queues requests which provide all free buffers to the kernel, one per run of consecutive ids.
+         * Buffers which find no free submission queue entry are kept for the next call.
+         * @param userData user data of the queued requests
+         */
+        void provide(IoUring &uring, uint64_t userData) {
+            if (returned.empty()) {
+                return;
+            }
+            std::sort(returned.begin(), returned.end());
+            size_t first = 0;
+            while (first < returned.size()) {
+                size_t last = first;
+                while (last + 1 < returned.size() && returned[last + 1] == returned[last] + 1) {
+                    last++;
+                }
+                io_uring_sqe *sqe = uring.getSqe();
+                if (sqe == nullptr) {
+                    break;
+                }
+                sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+                sqe->fd = (int) (last - first + 1);
+                sqe->addr = (uint64_t) (uintptr_t) get(returned[first]);
+                sqe->len = (uint32_t) bufferSize;
+                sqe->off = returned[first];
+                sqe->buf_group = groupId;
+                sqe->user_data = userData;
+                first = last + 1;
+            }
+            returned.erase(returned.begin(), returned.begin() + first);
+        }
+
+    private:
+        uint16_t groupId;
+        size_t bufferSize;
+        std::unique_ptr<uint8_t[]> storage;
+        std::vector<uint16_t> returned;
+    };
+}
+
+#endif //DCPLIB_URINGHELPER_H
@@ -47,9 +47,75 @@
 #include "dcp/xml/DcpSlaveDescriptionElements.hpp"
 
 #include <dcp/helper/Helper.hpp>
+#include <dcp/helper/TimerWheel.hpp>
 
 #include <thread>
 #include <iostream>
+#include <stdexcept>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+namespace internal {
+    /**
+     * Reusable outbound PDUs of type T, one per data/param id. The stream of a PDU is
+     * only reallocated if a larger payload is requested, so repeated sends do not allocate.
+     * The pool itself is thread safe, filling and sending one id from several threads is not.
+     */
+    template<typename T>
+    class DatPduPool {
+    public:
+        /**
+         * Returns the pooled PDU for id, resized to hold payloadSize bytes of payload.
+         * @throws std::invalid_argument if payloadSize does not fit into a PDU
+         */
+        T &acquire(const uint16_t id, const size_t payloadSize) {
+            if (payloadSize > UINT16_MAX) {
+                throw std::invalid_argument("Payload of " + std::to_string(payloadSize)
+                                            + " bytes exceeds the maximum PDU size");
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            Entry &entry = entries[id];
+            if (entry.pdu == nullptr || entry.capacity < payloadSize) {
+                entry.pdu.reset(new T(0, id, (uint16_t) payloadSize));
+                entry.capacity = payloadSize;
+            }
+            entry.pdu->setPduSize(5 + payloadSize);
+            return *entry.pdu;
+        }
+
+        /**
+         * Returns the pooled PDU for id, or nullptr if acquire was never called for id.
+         */
+        T *get(const uint16_t id) {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = entries.find(id);
+            return it == entries.end() ? nullptr : it->second.pdu.get();
+        }
+
+    private:
+        struct Entry {
+            std::unique_ptr<T> pdu;
+            size_t capacity = 0;
+        };
+        std::map<uint16_t, Entry> entries;
+        std::mutex mtx;
+    };
+
+    /**
+     * One flag per callback type, indexed without a lookup.
+     */
+    class CallbackFlags {
+    public:
+        bool &operator[](DcpCallbackTypes type) {
+            return flags[(size_t) type];
+        }
+
+    private:
+        //REALTIME_OVERRUN is the last callback type
+        bool flags[(size_t) DcpCallbackTypes::REALTIME_OVERRUN + 1] = {};
+    };
+}
 
 /**
  * DCP management of a master.
@@ -64,14 +130,24 @@ public:
      * Intanciates a DCP manager of a master
      * @param driver Driver object of the DCP master.
      */
-    DcpManagerMaster(DcpDriver driver) {
+    DcpManagerMaster(DcpDriver driver) : heartbeats(256), payloadPool(1024) {
         this->driver = driver;
         this->masterId = 0;
     }
 
-    virtual ~DcpManagerMaster() {}
+    virtual ~DcpManagerMaster() {
+        heartbeats.stop();
+    }
 
     virtual void receive(DcpPdu &msg) override {
+        receive(msg, PooledBuffer());
+    }
+
+    /**
+     * Handles a PDU which lies in buffer. Payloads passed to ASYNC listeners keep a reference
+     * to buffer instead of being copied. If buffer is empty, they are copied to a pooled buffer.
+     */
+    void receive(DcpPdu &msg, const PooledBuffer &buffer) {
         //check sequence id
         switch(msg.getTypeId()){
             case DcpPduType::RSP_ack:
@@ -84,8 +160,7 @@ public:
                     if (synchronousCallback[DcpCallbackTypes::PDU_MISSED]) {
                         pduMissedListener(pdu.getSender());
                     } else {
-                        std::thread t(pduMissedListener, pdu.getSender());
-                        t.detach();
+                        callbackExecutor.post(pdu.getSender(), std::bind(pduMissedListener, pdu.getSender()));
                     }
                 }
                 break;
@@ -96,8 +171,8 @@ public:
                     if (synchronousCallback[DcpCallbackTypes::IN_OUT_MISSED]) {
                         inputOutputPduMissedListener(data.getDataId());
                     } else {
-                        std::thread t(inputOutputPduMissedListener, data.getDataId());
-                        t.detach();
+                        callbackExecutor.post(dataCallbackKey(data.getDataId()),
+                                              std::bind(inputOutputPduMissedListener, data.getDataId()));
                     }
                 }
                 break;
@@ -133,8 +208,7 @@ public:
                 if (synchronousCallback[DcpCallbackTypes::ACK]) {
                     ackReceivedListener(ack.getSender(), ack.getRespSeqId());
                 } else {
-                    std::thread t(ackReceivedListener, ack.getSender(), ack.getRespSeqId());
-                    t.detach();
+                    callbackExecutor.post(ack.getSender(), std::bind(ackReceivedListener, ack.getSender(), ack.getRespSeqId()));
                 }
                 break;
             }
@@ -144,9 +218,9 @@ public:
                     nAckReceivedListener(nack.getSender(), nack.getRespSeqId(),
                                          nack.getErrorCode());
                 } else {
-                    std::thread t(nAckReceivedListener, nack.getSender(), nack.getRespSeqId(),
-                                  nack.getErrorCode());
-                    t.detach();
+                    callbackExecutor.post(nack.getSender(),
+                                          std::bind(nAckReceivedListener, nack.getSender(), nack.getRespSeqId(),
+                                                    nack.getErrorCode()));
                 }
                 break;
             }
@@ -156,9 +230,9 @@ public:
                     stateAckReceivedListener(stateAck.getSender(),
                                              stateAck.getRespSeqId(), stateAck.getStateId());
                 } else {
-                    std::thread t(stateAckReceivedListener, stateAck.getSender(),
-                                  stateAck.getRespSeqId(), stateAck.getStateId());
-                    t.detach();
+                    callbackExecutor.post(stateAck.getSender(),
+                                          std::bind(stateAckReceivedListener, stateAck.getSender(),
+                                                    stateAck.getRespSeqId(), stateAck.getStateId()));
                 }
                 break;
             }
@@ -169,9 +243,9 @@ public:
                     errorAckReceivedListener(errorAck.getSender(),
                                              errorAck.getRespSeqId(), errorAck.getErrorCode());
                 } else {
-                    std::thread t(errorAckReceivedListener, errorAck.getSender(),
-                                  errorAck.getRespSeqId(), errorAck.getErrorCode());
-                    t.detach();
+                    callbackExecutor.post(errorAck.getSender(),
+                                          std::bind(errorAckReceivedListener, errorAck.getSender(),
+                                                    errorAck.getRespSeqId(), errorAck.getErrorCode()));
                 }
                 break;
             }
@@ -201,8 +275,8 @@ public:
                     if (synchronousCallback[DcpCallbackTypes::RSP_log_ack]) {
                         logAckListener(logAck.getSender(), logAck.getRespSeqId(), entries);
                     } else {
-                        std::thread t(logAckListener, logAck.getSender(), logAck.getRespSeqId(), entries);
-                        t.detach();
+                        callbackExecutor.post(logAck.getSender(),
+                                              std::bind(logAckListener, logAck.getSender(), logAck.getRespSeqId(), entries));
                     }
                 }
                 break;
@@ -214,9 +288,9 @@ public:
                     stateChangedNotificationReceivedListener(stateChanged.getSender(),
                                                              stateChanged.getStateId());
                 } else {
-                    std::thread t(stateChangedNotificationReceivedListener, stateChanged.getSender(),
-                                  stateChanged.getStateId());
-                    t.detach();
+                    callbackExecutor.post(stateChanged.getSender(),
+                                          std::bind(stateChangedNotificationReceivedListener, stateChanged.getSender(),
+                                                    stateChanged.getStateId()));
                 }
                 break;
             }
@@ -237,8 +311,7 @@ public:
                         if (synchronousCallback[DcpCallbackTypes::NTF_LOG]) {
                             logNotificationListener(log.getSender(), sharedPtr);
                         } else {
-                            std::thread t(logNotificationListener, log.getSender(), sharedPtr);
-                            t.detach();
+                            callbackExecutor.post(log.getSender(), std::bind(logNotificationListener, log.getSender(), sharedPtr));
                         }
                     } else {
                         break;
@@ -249,11 +322,29 @@ public:
             }
             case DcpPduType::DAT_input_output: {
                 DcpPduDatInputOutput &data = static_cast<DcpPduDatInputOutput &>(msg);
+                size_t length = data.getPduSize() - data.getCorrectSize();
                 if (synchronousCallback[DcpCallbackTypes::DATA]) {
-                    dataReceivedListener(data.getDataId(), data.getPduSize() - data.getCorrectSize(), data.getPayload());
+                    if (dataSliceReceivedListener) {
+                        dataSliceReceivedListener(data.getDataId(),
+                                                  buffer ? PayloadSlice(buffer, data.getPayload(), length)
+                                                         : payloadPool.copy(data.getPayload(), length));
+                    } else {
+                        dataReceivedListener(data.getDataId(), length, data.getPayload());
+                    }
                 } else {
-                    std::thread t(dataReceivedListener, data.getDataId(), data.getPduSize() - data.getCorrectSize(), data.getPayload());
-                    t.detach();
+                    //the receive buffer is reused by the driver, so the listener gets a slice which keeps it alive
+                    PayloadSlice slice = buffer ? PayloadSlice(buffer, data.getPayload(), length)
+                                                : payloadPool.copy(data.getPayload(), length);
+                    uint16_t dataId = data.getDataId();
+                    if (dataSliceReceivedListener) {
+                        callbackExecutor.post(dataCallbackKey(dataId),
+                                              std::bind(dataSliceReceivedListener, dataId, std::move(slice)));
+                    } else {
+                        std::function<void(uint16_t, size_t, uint8_t *)> &listener = dataReceivedListener;
+                        callbackExecutor.post(dataCallbackKey(dataId), [listener, dataId, slice] {
+                            listener(dataId, slice.size(), slice.data());
+                        });
+                    }
                 }
                 break;
             }
@@ -265,8 +356,7 @@ public:
         if (synchronousCallback[DcpCallbackTypes::ERROR_LI]) {
             errorListener(errorCode);
         } else {
-            std::thread t(errorListener, errorCode);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::ERROR_LI, std::bind(errorListener, errorCode));
         }
     }
 
@@ -534,6 +624,7 @@ public:
                                                    dcpId, dataId, port, ipAddress,  DcpTransportProtocol::UDP_IPv4};
         driver.send(pdu);
         slaveIdToDataIdIn[dcpId].push_back(dataId);
+        setDataSender(dataId, dcpId);
     }
 
     /**
@@ -553,6 +644,44 @@ public:
                                                    dcpId, dataId, port, ipAddress,  DcpTransportProtocol::TCP_IPv4};
         driver.send(pdu);
         slaveIdToDataIdIn[dcpId].push_back(dataId);
+        setDataSender(dataId, dcpId);
+    }
+
+    /**
+     * Send a CFG_target_network_information PDU for the SHARED_MEMORY transport protocol
+     *
+     * @param dcpId Receiver of the PDU
+     * @param dataId Data id for which this configuration is valid
+     * @param ipAddress Ip address of the shared memory endpoint receiving the DAT_input_output PDU
+     * @param port Port of the shared memory endpoint receiving the DAT_input_output PDU
+     *
+     * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    void CFG_target_network_information_SHM(const uint8_t dcpId,
+                                            const uint16_t dataId, const uint32_t ipAddress,
+                                            const uint16_t port) {
+        DcpPduCfgNetworkInformationIPv4 pdu = {DcpPduType::CFG_target_network_information, getNextSeqNum(dcpId),
+                                               dcpId, dataId, port, ipAddress, DcpTransportProtocol::SHARED_MEMORY};
+        driver.send(pdu);
+        slaveIdToDataIdIn[dcpId].push_back(dataId);
+        setDataSender(dataId, dcpId);
+    }
+
+    /**
+     * Send a CFG_target_network_information PDU for the UNIX_DOMAIN transport protocol
+     *
+     * @param dcpId Receiver of the PDU
+     * @param dataId Data id for which this configuration is valid
+     * @param path Path of the socket receiving the DAT_input_output PDU
+     *
+     * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    void CFG_target_network_information_UNIX(const uint8_t dcpId, const uint16_t dataId, const std::string &path) {
+        DcpPduCfgNetworkInformationPath pdu = {DcpPduType::CFG_target_network_information, getNextSeqNum(dcpId),
+                                               dcpId, dataId, path, DcpTransportProtocol::UNIX_DOMAIN};
+        driver.send(pdu);
+        slaveIdToDataIdIn[dcpId].push_back(dataId);
+        setDataSender(dataId, dcpId);
     }
 
     /**
@@ -591,6 +720,39 @@ public:
         slaveIdToDataIdOut[dcpId].push_back(dataId);
     }
 
+    /**
+     * Send a CFG_source_network_information PDU for the SHARED_MEMORY transport protocol
+     * @param dcpId Receiver of the PDU
+     * @param dataId Data id for which this configuration is valid
+     * @param ipAddress Ip address of the shared memory endpoint the slave has to create for DAT_input_output PDU
+     * @param port Port of the shared memory endpoint the slave has to create for DAT_input_output PDU
+     *
+     * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    void CFG_source_network_information_SHM(const uint8_t dcpId,
+                                            const uint16_t dataId, const uint32_t ipAddress,
+                                            const uint16_t port) {
+        DcpPduCfgNetworkInformationIPv4 pdu = {DcpPduType::CFG_source_network_information, getNextSeqNum(dcpId),
+                                               dcpId, dataId, port, ipAddress, DcpTransportProtocol::SHARED_MEMORY};
+        driver.send(pdu);
+        slaveIdToDataIdOut[dcpId].push_back(dataId);
+    }
+
+    /**
+     * Send a CFG_source_network_information PDU for the UNIX_DOMAIN transport protocol
+     * @param dcpId Receiver of the PDU
+     * @param dataId Data id for which this configuration is valid
+     * @param path Path of the socket the slave has to bind for DAT_input_output PDU
+     *
+     * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    void CFG_source_network_information_UNIX(const uint8_t dcpId, const uint16_t dataId, const std::string &path) {
+        DcpPduCfgNetworkInformationPath pdu = {DcpPduType::CFG_source_network_information, getNextSeqNum(dcpId),
+                                               dcpId, dataId, path, DcpTransportProtocol::UNIX_DOMAIN};
+        driver.send(pdu);
+        slaveIdToDataIdOut[dcpId].push_back(dataId);
+    }
+
     /**
      * Send a CFG_parameter PDU
      * @param dcpId Receiver of the PDU
@@ -664,6 +826,39 @@ public:
         slaveIdToParamId[dcpId].push_back(paramId);
     }
 
+    /**
+    * Send a CFG_param_network_information PDU for the SHARED_MEMORY transport protocol
+    * @param dcpId Receiver of the PDU
+    * @param paramId Parameter id for which this configuration is valid
+    * @param ipAddress Ip address of the shared memory endpoint the slave has to create for DAT_parameter PDU
+    * @param port Port of the shared memory endpoint the slave has to create for DAT_parameter PDU
+    *
+    * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+    */
+    void CFG_param_network_information_SHM(const uint8_t dcpId,
+                                           const uint16_t paramId, const uint32_t ipAddress,
+                                           const uint16_t port) {
+        DcpPduCfgParamNetworkInformationIPv4 pdu = {getNextSeqNum(dcpId), dcpId, paramId,
+                                                    port, ipAddress, DcpTransportProtocol::SHARED_MEMORY};
+        driver.send(pdu);
+        slaveIdToParamId[dcpId].push_back(paramId);
+    }
+
+    /**
+    * Send a CFG_param_network_information PDU for the UNIX_DOMAIN transport protocol
+    * @param dcpId Receiver of the PDU
+    * @param paramId Parameter id for which this configuration is valid
+    * @param path Path of the socket the slave has to bind for DAT_parameter PDU
+    *
+    * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
+    */
+    void CFG_param_network_information_UNIX(const uint8_t dcpId, const uint16_t paramId, const std::string &path) {
+        DcpPduCfgParamNetworkInformationPath pdu = {getNextSeqNum(dcpId), dcpId, paramId, path,
+                                                    DcpTransportProtocol::UNIX_DOMAIN};
+        driver.send(pdu);
+        slaveIdToParamId[dcpId].push_back(paramId);
+    }
+
     /**
      * Send a CFG_logging PDU
      * @param dcpId Receiver of the PDU
@@ -701,8 +896,39 @@ public:
      * @pre setTargetParamNetworkInformation of the given DcpDriver was called for dcpId before
      */
     void DAT_parameter(const uint16_t paramId, uint8_t *configuration, size_t configurationLength) {
-        DcpPduDatParameter parameter = {getNextParameterSeqNum(paramId), paramId, configuration, configurationLength};
-        driver.send(parameter);
+        memcpy(DAT_parameter_buffer(paramId, configurationLength), configuration, configurationLength);
+        DAT_parameter_commit(paramId);
+    }
+
+    /**
+     * Returns the writable configuration of the pooled DAT_parameter PDU for paramId.
+     * The values can be serialized directly into it and are sent by DAT_parameter_commit.
+     * The buffer is reused for every send of this paramId.
+     * @param paramId Parameter id of the PDU
+     * @param configurationLength Number of bytes which will be written
+     * @return Pointer to configurationLength writable bytes, valid until the next call for paramId
+     */
+    uint8_t *DAT_parameter_buffer(const uint16_t paramId, size_t configurationLength) {
+        return parameterPool.acquire(paramId, configurationLength).getConfiguration();
+    }
+
+    /**
+     * Send the pooled DAT_parameter PDU for paramId with the next sequence id
+     * @param paramId Parameter id of the PDU
+     * @return Sequence id the PDU was sent with
+     *
+     * @pre DAT_parameter_buffer was called for paramId before
+     * @pre setTargetParamNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    uint16_t DAT_parameter_commit(const uint16_t paramId) {
+        DcpPduDatParameter *parameter = parameterPool.get(paramId);
+        if (parameter == nullptr) {
+            throw std::invalid_argument("No DAT_parameter buffer for param id " + std::to_string(paramId));
+        }
+        uint16_t seqId = getNextParameterSeqNum(paramId);
+        parameter->getPduSeqId() = seqId;
+        driver.send(*parameter);
+        return seqId;
     }
 
     /**
@@ -714,8 +940,39 @@ public:
     * @pre setTargetNetworkInformation of the given DcpDriver was called for dcpId before
     */
     void DAT_input_output(const uint16_t dataId, uint8_t *configuration, size_t configurationLength) {
-        DcpPduDatInputOutput data = { getNextDataSeqNum(dataId), dataId, configuration, configurationLength};
-        driver.send(data);
+        memcpy(DAT_input_output_buffer(dataId, configurationLength), configuration, configurationLength);
+        DAT_input_output_commit(dataId);
+    }
+
+    /**
+     * Returns the writable payload of the pooled DAT_input_output PDU for dataId.
+     * The values can be serialized directly into it and are sent by DAT_input_output_commit.
+     * The buffer is reused for every send of this dataId.
+     * @param dataId Data id of the PDU
+     * @param payloadLength Number of bytes which will be written
+     * @return Pointer to payloadLength writable bytes, valid until the next call for dataId
+     */
+    uint8_t *DAT_input_output_buffer(const uint16_t dataId, size_t payloadLength) {
+        return dataPool.acquire(dataId, payloadLength).getPayload();
+    }
+
+    /**
+     * Send the pooled DAT_input_output PDU for dataId with the next sequence id
+     * @param dataId Data id of the PDU
+     * @return Sequence id the PDU was sent with
+     *
+     * @pre DAT_input_output_buffer was called for dataId before
+     * @pre setTargetNetworkInformation of the given DcpDriver was called for dcpId before
+     */
+    uint16_t DAT_input_output_commit(const uint16_t dataId) {
+        DcpPduDatInputOutput *data = dataPool.get(dataId);
+        if (data == nullptr) {
+            throw std::invalid_argument("No DAT_input_output buffer for data id " + std::to_string(dataId));
+        }
+        uint16_t seqId = getNextDataSeqNum(dataId);
+        data->getPduSeqId() = seqId;
+        driver.send(*data);
+        return seqId;
     }
 
     /**
@@ -727,11 +984,12 @@ public:
      * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
      */
     void enableHeartbeat(const uint8_t dcpId, const uint32_t numerator, const uint32_t denominator) {
-        //close existing heartbeat thread if exist
-        disableHeartbeat(dcpId);
-        runningHeartbeats[dcpId] = true;
-        heartbeatThreads[dcpId] = std::unique_ptr<std::thread>(
-                new std::thread(&DcpManagerMaster::heartBeatRoutine, this, dcpId, numerator, denominator));
+#ifdef DEBUG
+        Log(SENDING_HEARTBEAT_STARTED, dcpId, numerator, denominator);
+#endif
+        std::chrono::microseconds between((int64_t) (1000000 * ((double) numerator) / ((double) denominator)));
+        //replaces an existing heartbeat of dcpId
+        heartbeats.setTimer(dcpId, between, [this, dcpId] { INF_state(dcpId); });
     }
 
     /**
@@ -741,12 +999,10 @@ public:
      * @pre setSlaveNetworkInformation of the given DcpDriver was called for dcpId before
      */
     void disableHeartbeat(const uint8_t dcpId) {
-        if (heartbeatThreads.count(dcpId)) {
-            runningHeartbeats[dcpId] = false;
-            heartbeatCV[dcpId].notify_all();
-            heartbeatThreads[dcpId]->join();
-            heartbeatThreads.erase(dcpId);
-            runningHeartbeats.erase(dcpId);
+        if (heartbeats.cancelTimer(dcpId)) {
+#ifdef DEBUG
+            Log(SENDING_HEARTBEAT_STOPPED, dcpId);
+#endif
         }
     }
 
@@ -869,6 +1125,20 @@ public:
     template<FunctionType ftype>
     void setDataReceivedListener(const std::function<void(uint16_t, size_t, uint8_t *)> dataReceivedListener) {
         this->dataReceivedListener = std::move(dataReceivedListener);
+        this->dataSliceReceivedListener = nullptr;
+        synchronousCallback[DcpCallbackTypes::DATA] = ftype == SYNC;
+    }
+
+    /**
+     * Set the listener for DAT_input_output PDUs. The payload is passed as slice of the receive
+     * buffer, which may be kept after the call. The buffer is reused when the last slice is dropped.
+     * Replaces a listener set by setDataReceivedListener.
+     * @tparam ftype SYNC means calling the given function is blocking, ASYNC means non blocking
+     * @param dataSliceReceivedListener function which will be called after the event occurs
+     */
+    template<FunctionType ftype>
+    void setDataSliceReceivedListener(const std::function<void(uint16_t, PayloadSlice)> dataSliceReceivedListener) {
+        this->dataSliceReceivedListener = std::move(dataSliceReceivedListener);
         synchronousCallback[DcpCallbackTypes::DATA] = ftype == SYNC;
     }
 
@@ -902,14 +1172,32 @@ public:
 
     DcpManager getDcpManager() override {
         return {[this](DcpPdu &msg) { receive(msg); },
-                [this](const DcpError errorCode) { reportError(errorCode); }};
+                [this](const DcpError errorCode) { reportError(errorCode); },
+                [this](DcpPdu &msg, const PooledBuffer &buffer) { receive(msg, buffer); }};
     }
 
 private:
-    std::map<uint8_t, bool> runningHeartbeats;
-    std::map<uint8_t, std::unique_ptr<std::thread>> heartbeatThreads;
-    std::map<uint8_t, std::condition_variable> heartbeatCV;
-    std::map<uint8_t, std::mutex> heartbeatMutex;
+    void setDataSender(const uint16_t dataId, const uint8_t dcpId) {
+        dataSenders[dataId].store(dcpId + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Ordering key of ASYNC callbacks for a DAT_input_output PDU. It is the id of the sending slave,
+     * which is also the key of its control PDU callbacks, so all callbacks of one slave keep their order.
+     * Data ids without configured sender are ordered by themselves.
+     */
+    size_t dataCallbackKey(const uint16_t dataId) {
+        uint16_t sender = dataSenders[dataId].load(std::memory_order_relaxed);
+        return sender != 0 ? sender - 1 : dataId;
+    }
+
+    internal::DatPduPool<DcpPduDatInputOutput> dataPool;
+    internal::DatPduPool<DcpPduDatParameter> parameterPool;
+
+    //one periodic INF_state timer per dcpId
+    TimerWheel heartbeats;
+    //DAT_input_output payloads of drivers without pooled receive buffers
+    BufferPool payloadPool;
 
     std::map<uint8_t, uint16_t> lastRegisterSeq;
     std::map<uint8_t, uint16_t> lastRegisterSuccessfullSeq;
@@ -918,8 +1206,11 @@ private:
     std::map<uint8_t, std::list<uint16_t>> slaveIdToDataIdIn;
     std::map<uint8_t, std::list<uint16_t>> slaveIdToDataIdOut;
     std::map<uint8_t, std::list<uint16_t>> slaveIdToParamId;
+    //slave which sends a data id to the master plus one, as configured by CFG_target_network_information.
+    //Indexed by data id, 0 if not configured. Read on every DAT PDU without lock
+    std::unique_ptr<std::atomic<uint16_t>[]> dataSenders{new std::atomic<uint16_t>[UINT16_MAX + 1]()};
 
-    std::map<DcpCallbackTypes, bool> synchronousCallback;
+    internal::CallbackFlags synchronousCallback;
     std::function<void(uint8_t sender, uint16_t pduSeqId)> ackReceivedListener = [](uint8_t sender,
                                                                                     uint16_t pduSeqId) {};
     std::function<void(uint8_t sender, uint16_t pduSeqId,
@@ -940,6 +1231,7 @@ private:
     std::function<void(uint16_t dataId, size_t length, uint8_t payload[])> dataReceivedListener = [](uint16_t dataId,
                                                                                                      size_t length,
                                                                                                      uint8_t payload[]) {};
+    std::function<void(uint16_t dataId, PayloadSlice payload)> dataSliceReceivedListener;
     std::function<void(uint8_t sender, uint16_t pduSeqId,
                        std::vector<std::shared_ptr<LogEntry>> entries)> logAckListener = [](uint8_t sender,
                                                                                             uint16_t pduSeqId,
@@ -959,25 +1251,6 @@ private:
                                                               DcpLogLevel::LVL_INFORMATION,
                                                               "Stop sending heartbeat to slave id %uint8.",
                                                               {DcpDataType::uint8});
-
-    void heartBeatRoutine(const uint8_t dcpId, const uint32_t numerator, const uint32_t denominator) {
-        using namespace std::chrono;
-#ifdef DEBUG
-        Log(SENDING_HEARTBEAT_STARTED, dcpId, numerator, denominator);
-#endif
-        int64_t between = (int64_t) (1000000 * ((double) numerator) / ((double) denominator));
-        std::unique_lock<std::mutex> lk(heartbeatMutex[dcpId]);
-
-        while (runningHeartbeats[dcpId]) {
-            time_point<system_clock> now = time_point_cast<microseconds>(system_clock::now());
-            INF_state(dcpId);
-            time_point<system_clock> nextCheck = now + microseconds(between);
-            heartbeatCV[dcpId].wait_until(lk, nextCheck);
-        }
-#ifdef DEBUG
-        Log(SENDING_HEARTBEAT_STOPPED, dcpId);
-#endif
-    }
 };
 
 #endif /* ACI_LOGIC_DRIVERMANAGERMASTER_H_ */
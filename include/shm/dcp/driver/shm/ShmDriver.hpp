@@ -0,0 +1,754 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_SHMDRIVER_HPP
+#define DCPLIB_SHMDRIVER_HPP
+
+#include <dcp/driver/DcpDriver.hpp>
+#include <dcp/logic/Logable.hpp>
+#include <dcp/model/DcpTypes.hpp>
+#include <dcp/model/pdu/DcpPduBasic.hpp>
+#include <dcp/model/pdu/DcpPduDatInputOutput.hpp>
+#include <dcp/model/pdu/DcpPduDatParameter.hpp>
+#include <dcp/model/pdu/DcpPduFactory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace internal {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && ATOMIC_INT_LOCK_FREE == 2,
+                  "futex words must be plain lock free 32 bit integers");
+
+    inline void futexWait(std::atomic<uint32_t> &word, uint32_t expected, const struct timespec *timeout) {
+        syscall(SYS_futex, (uint32_t *) &word, FUTEX_WAIT, expected, timeout, nullptr, 0);
+    }
+
+    inline void futexWake(std::atomic<uint32_t> &word) {
+        syscall(SYS_futex, (uint32_t *) &word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    /**
+     * Control block of one single producer single consumer ring in a shared memory segment.
+     * head is only written by the producer, tail only by the consumer.
+     */
+    struct ShmRingHeader {
+        //sender key + 1 of the driver owning this ring, 0 if the ring is free
+        alignas(64) std::atomic<uint64_t> producer;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    /**
+     * Header of a shared memory segment. A segment belongs to one receiving address
+     * and holds one ring per sending driver.
+     */
+    struct ShmSegmentHeader {
+        std::atomic<uint32_t> magic;
+        uint32_t numRings;
+        uint64_t ringCapacity;
+        uint64_t key;
+        //name of the segment holding the futex word and sleep flag of the receiver
+        char doorbell[48];
+        std::atomic<uint32_t> closed;
+        alignas(64) std::atomic<uint32_t> wakeups;
+        std::atomic<uint32_t> sleeping;
+        alignas(64) std::atomic<uint64_t> dropped;
+    };
+
+    /**
+     * View on one ring. Records are a 4 byte PDU length followed by the PDU, padded to 8 bytes,
+     * so a record has the same layout as the receive buffers of the other drivers.
+     */
+    class ShmRing {
+    public:
+        ShmRing() : header(nullptr), data(nullptr), mask(0) {}
+
+        ShmRing(ShmRingHeader *header, uint8_t *data, uint64_t capacity) : header(header), data(data),
+                                                                           mask(capacity - 1) {}
+
+        ShmRingHeader *getHeader() const {
+            return header;
+        }
+
+        /**
+         * Producer side.
+         * @return False if the ring has not enough free space. Nothing is written then.
+         */
+        bool write(const uint8_t *pdu, uint32_t size) {
+            uint64_t record = recordSize(size);
+            uint64_t head = header->head.load(std::memory_order_relaxed);
+            uint64_t tail = header->tail.load(std::memory_order_acquire);
+            uint64_t pos = head & mask;
+            uint64_t contiguous = mask + 1 - pos;
+            uint64_t needed = record > contiguous ? contiguous + record : record;
+            if (record > (mask + 1) / 2 || head + needed - tail > mask + 1) {
+                return false;
+            }
+            if (record > contiguous) {
+                *((uint32_t *) (data + pos)) = WRAP;
+                head += contiguous;
+                pos = 0;
+            }
+            *((uint32_t *) (data + pos)) = size;
+            std::memcpy(data + pos + 4, pdu, size);
+            header->head.store(head + record, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer side. A record which does not fit into the written part of the ring can only come
+         * from a corrupt or hostile producer. The content of the ring is discarded then.
+         * @param corrupt Set to true if the ring was discarded
+         * @return The oldest record, or nullptr if the ring is empty. Valid until pop.
+         */
+        uint8_t *peek(uint32_t &size, bool &corrupt) {
+            uint64_t tail = header->tail.load(std::memory_order_relaxed);
+            uint64_t head;
+            while (tail != (head = header->head.load(std::memory_order_acquire))) {
+                uint64_t pos = tail & mask;
+                size = *((uint32_t *) (data + pos));
+                if (size == WRAP) {
+                    tail += mask + 1 - pos;
+                    header->tail.store(tail, std::memory_order_release);
+                    continue;
+                }
+                if (size > mask + 1 - pos - 4 || head - tail > mask + 1 || recordSize(size) > head - tail) {
+                    header->tail.store(head, std::memory_order_release);
+                    corrupt = true;
+                    return nullptr;
+                }
+                return data + pos;
+            }
+            return nullptr;
+        }
+
+        void pop(uint32_t size) {
+            header->tail.store(header->tail.load(std::memory_order_relaxed) + recordSize(size),
+                               std::memory_order_release);
+        }
+
+        bool empty() const {
+            return header->tail.load(std::memory_order_relaxed) == header->head.load(std::memory_order_acquire);
+        }
+
+    private:
+        static const uint32_t WRAP = 0xFFFFFFFF;
+
+        ShmRingHeader *header;
+        uint8_t *data;
+        uint64_t mask;
+
+        static uint64_t recordSize(uint32_t size) {
+            return (4 + (uint64_t) size + 7) & ~((uint64_t) 7);
+        }
+    };
+
+    /**
+     * Mapping of a named POSIX shared memory segment. The creator of a segment unlinks it on destruction.
+     */
+    class ShmSegment {
+    public:
+        static const uint32_t MAGIC = 0x44435053;
+
+        ShmSegment(const ShmSegment &) = delete;
+
+        ShmSegment &operator=(const ShmSegment &) = delete;
+
+        ~ShmSegment() {
+            retire();
+            munmap(base, size);
+        }
+
+        /**
+         * Marks a created segment as closed, so senders drop their rings in it, and unlinks its name
+         * unless the name already refers to a newer segment.
+         */
+        void retire() {
+            if (!owner || header->closed.exchange(1)) {
+                return;
+            }
+            int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd >= 0) {
+                struct stat st;
+                bool same = fstat(fd, &st) == 0 && st.st_ino == inode && st.st_dev == device;
+                ::close(fd);
+                if (same) {
+                    shm_unlink(name.c_str());
+                }
+            }
+        }
+
+        static std::string nameOf(uint64_t key) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/dcplib_%08x_%u", (unsigned int) (key >> 16),
+                          (unsigned int) (key & 0xFFFF));
+            return name;
+        }
+
+        /**
+         * Creates the segment for key. A stale segment of the same name is replaced.
+         * @return nullptr if the segment could not be created
+         */
+        static std::unique_ptr<ShmSegment> create(uint64_t key, uint32_t numRings, uint64_t ringCapacity,
+                                                  const std::string &doorbell) {
+            std::string name = nameOf(key);
+            size_t size = sizeOf(numRings, ringCapacity);
+            shm_unlink(name.c_str());
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) {
+                return nullptr;
+            }
+            struct stat st;
+            void *base = MAP_FAILED;
+            if (ftruncate(fd, (off_t) size) == 0 && fstat(fd, &st) == 0) {
+                base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                shm_unlink(name.c_str());
+                return nullptr;
+            }
+            std::unique_ptr<ShmSegment> segment(new ShmSegment(name, (uint8_t *) base, size, true));
+            segment->inode = st.st_ino;
+            segment->device = st.st_dev;
+            ShmSegmentHeader *header = new(base) ShmSegmentHeader();
+            header->numRings = numRings;
+            header->ringCapacity = ringCapacity;
+            header->key = key;
+            std::strncpy(header->doorbell, doorbell.c_str(), sizeof(header->doorbell) - 1);
+            header->closed.store(0, std::memory_order_relaxed);
+            header->wakeups.store(0, std::memory_order_relaxed);
+            header->sleeping.store(0, std::memory_order_relaxed);
+            header->dropped.store(0, std::memory_order_relaxed);
+            for (uint32_t i = 0; i < numRings; i++) {
+                ShmRingHeader *ring = new(segment->ringHeader(i)) ShmRingHeader();
+                ring->producer.store(0, std::memory_order_relaxed);
+                ring->head.store(0, std::memory_order_relaxed);
+                ring->tail.store(0, std::memory_order_relaxed);
+            }
+            segment->header = header;
+            header->magic.store(MAGIC, std::memory_order_release);
+            return segment;
+        }
+
+        /**
+         * Maps an existing segment.
+         * @return nullptr if the segment does not exist or is not initialized yet
+         */
+        static std::unique_ptr<ShmSegment> open(const std::string &name) {
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0) {
+                return nullptr;
+            }
+            struct stat st;
+            void *base = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(ShmSegmentHeader)) {
+                base = mmap(nullptr, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                return nullptr;
+            }
+            std::unique_ptr<ShmSegment> segment(new ShmSegment(name, (uint8_t *) base, (size_t) st.st_size, false));
+            ShmSegmentHeader *header = (ShmSegmentHeader *) base;
+            if (header->magic.load(std::memory_order_acquire) != MAGIC
+                || sizeOf(header->numRings, header->ringCapacity) > segment->size) {
+                return nullptr;
+            }
+            segment->header = header;
+            return segment;
+        }
+
+        ShmSegmentHeader &getHeader() {
+            return *header;
+        }
+
+        const std::string &getName() const {
+            return name;
+        }
+
+        ShmRing ring(uint32_t i) {
+            return ShmRing(ringHeader(i), base + ringsOffset(header->numRings) + i * header->ringCapacity,
+                           header->ringCapacity);
+        }
+
+    private:
+        std::string name;
+        uint8_t *base;
+        size_t size;
+        bool owner;
+        ShmSegmentHeader *header;
+        ino_t inode;
+        dev_t device;
+
+        ShmSegment(const std::string &name, uint8_t *base, size_t size, bool owner) : name(name), base(base),
+                                                                                      size(size), owner(owner),
+                                                                                      header((ShmSegmentHeader *) base),
+                                                                                      inode(0), device(0) {}
+
+        static size_t ringsOffset(uint32_t numRings) {
+            return sizeof(ShmSegmentHeader) + numRings * sizeof(ShmRingHeader);
+        }
+
+        static size_t sizeOf(uint32_t numRings, uint64_t ringCapacity) {
+            return ringsOffset(numRings) + numRings * ringCapacity;
+        }
+
+        ShmRingHeader *ringHeader(uint32_t i) {
+            return (ShmRingHeader *) (base + sizeof(ShmSegmentHeader)) + i;
+        }
+    };
+}
+
+/**
+ * DcpDriver for processes on the same host, e.g. a master and model processes beside it.
+ * Every receiving address is a named POSIX shared memory segment, which holds one single producer
+ * single consumer ring per sending driver. PDUs are written straight into the ring of the receiver
+ * and decoded there in place, without sockets or kernel buffers.
+ * A sleeping receiver is woken by a futex in its main segment. In busy poll mode the receiver never sleeps,
+ * which saves the wake up latency at the cost of one core.
+ * The network information has the format of UDP_IPv4 and the transport protocol SHARED_MEMORY,
+ * the segment of address ip:port is named /dcplib_<ip as hex>_<port>. Linux only.
+ * PDUs sent while the receiving segment does not exist or its ring is full are dropped, as a socket would.
+ */
+class ShmDriver : public Logable {
+public:
+    /**
+     * @param host Ip address of the main segment of this driver
+     * @param port Port of the main segment of this driver
+     * @param ringCapacity Size of each ring in bytes. Rounded up to the next power of two.
+     * @param numRings Maximum number of drivers which can send to one address of this driver
+     */
+    ShmDriver(std::string host, uint16_t port, size_t ringCapacity = 64 * 1024, uint32_t numRings = 16)
+            : numRings(numRings > 0 ? numRings : 1), busyPoll(false), stopped(false), version(0), dropped(0),
+              timerArmed(false) {
+        this->ringCapacity = 64;
+        while (this->ringCapacity < ringCapacity) {
+            this->ringCapacity *= 2;
+        }
+        mainKey = key(parseIp(host), port);
+    }
+
+    ~ShmDriver() {
+        stopReceiving();
+        std::lock_guard<std::mutex> lock(mtxReceiving);
+        ports.clear();
+        main.reset();
+    }
+
+    /**
+     * Let the receiver spin on its rings instead of sleeping on the futex. Default is false.
+     */
+    void setBusyPoll(bool busyPoll) {
+        this->busyPoll = busyPoll;
+        ring();
+    }
+
+    /**
+     * @return Number of PDUs not sent because the receiver did not exist or its ring was full
+     */
+    uint64_t getDroppedPdus() const {
+        return dropped;
+    }
+
+    DcpDriver getDcpDriver() {
+        return {[this](DcpPdu &msg) { this->send(msg); },
+                [this](dcpId_t dcpId, uint8_t *info) {
+                    otherSlaves[dcpId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioIn[dataId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](dataId_t dataId, uint8_t *info) {
+                    ioOut[dataId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramIn[paramId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                [this](paramId_t paramId, uint8_t *info) {
+                    paramOut[paramId] = key(*((ip_address_t *) (info + 2)), *((uint16_t *) info));
+                },
+                std::bind(&ShmDriver::startReceiving, this),
+                [this](dcpId_t) {/*nothing to do for connectionless shared memory*/ },
+                [this](dcpId_t) {/*nothing to do for connectionless shared memory*/ },
+                [this](DcpManager manager) {
+                    this->dcpManager = manager;
+                },
+                [this](const LogManager &logManager) {
+                    setLogManager(logManager);
+                },
+                [this]() { masterKey = lastAccess.load(std::memory_order_relaxed); },
+                std::bind(&ShmDriver::openPorts, this),
+                [this]() {/*nothing to do for connectionless shared memory*/ },
+                std::bind(&ShmDriver::closeConfiguredPorts, this),
+                [this]() {/*nothing to do for connectionless shared memory*/ },
+                std::bind(&ShmDriver::stopReceiving, this),
+                nullptr,
+                [this](std::chrono::steady_clock::time_point deadline, std::function<void()> callback) {
+                    std::lock_guard<std::mutex> lock(mtxTimer);
+                    this->deadline = deadline;
+                    timerCallback = std::move(callback);
+                    timerArmed = (bool) timerCallback;
+                    ring();
+                }
+        };
+    }
+
+private:
+    /**
+     * Ring of this driver in the segment of a receiver.
+     */
+    struct Connection {
+        std::shared_ptr<internal::ShmSegment> segment;
+        //segment with the futex of the receiver, may be segment itself
+        std::shared_ptr<internal::ShmSegment> doorbell;
+        internal::ShmRing ring;
+    };
+
+    struct Receiver {
+        std::shared_ptr<internal::ShmSegment> segment;
+        std::vector<internal::ShmRing> rings;
+    };
+
+    uint32_t numRings;
+    uint64_t ringCapacity;
+    uint64_t mainKey;
+    std::atomic_bool busyPoll;
+    std::atomic_bool stopped;
+    DcpManager dcpManager;
+
+    std::map<dcpId_t, uint64_t> otherSlaves;
+    std::map<dataId_t, uint64_t> ioOut;
+    std::map<paramId_t, uint64_t> paramOut;
+    std::map<dataId_t, uint64_t> ioIn;
+    std::map<paramId_t, uint64_t> paramIn;
+    uint64_t masterKey = 0;
+    //sender of the last PDU received on the main segment
+    std::atomic<uint64_t> lastAccess{0};
+
+    //segments this driver receives on, guarded by mtxReceiving. version is increased on every change
+    std::mutex mtxReceiving;
+    std::shared_ptr<internal::ShmSegment> main;
+    std::map<uint64_t, std::shared_ptr<internal::ShmSegment>> ports;
+    std::atomic<uint64_t> version;
+
+    std::mutex mtxSend;
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections;
+    std::map<std::string, std::shared_ptr<internal::ShmSegment>> doorbells;
+    std::atomic<uint64_t> dropped;
+
+    std::mutex mtxTimer;
+    std::atomic_bool timerArmed;
+    std::chrono::steady_clock::time_point deadline;
+    std::function<void()> timerCallback;
+
+    static uint64_t key(ip_address_t ip, port_t port) {
+        return ((uint64_t) ip << 16) | port;
+    }
+
+    static ip_address_t parseIp(const std::string &host) {
+        unsigned int a = 0, b = 0, c = 0, d = 0;
+        std::sscanf(host.c_str(), "%u.%u.%u.%u", &a, &b, &c, &d);
+        return (ip_address_t) ((a << 24) | (b << 16) | (c << 8) | d);
+    }
+
+    uint64_t getTarget(DcpPdu &msg) {
+        switch (msg.getTypeId()) {
+            case DcpPduType::DAT_input_output:
+                return ioOut[static_cast<DcpPduDatInputOutput &>(msg).getDataId()];
+            case DcpPduType::DAT_parameter:
+                return paramOut[static_cast<DcpPduDatParameter &>(msg).getParamId()];
+            case DcpPduType::NTF_state_changed:
+            case DcpPduType::NTF_log:
+                return masterKey;
+            case DcpPduType::RSP_ack:
+            case DcpPduType::RSP_nack:
+            case DcpPduType::RSP_state_ack:
+            case DcpPduType::RSP_error_ack:
+            case DcpPduType::RSP_log_ack:
+                return lastAccess.load(std::memory_order_relaxed);
+            default:
+                return otherSlaves[static_cast<DcpPduBasic &>(msg).getReceiver()];
+        }
+    }
+
+    void send(DcpPdu &msg) {
+        uint64_t target = getTarget(msg);
+        std::lock_guard<std::mutex> lock(mtxSend);
+        Connection *connection = connect(target);
+        if (connection == nullptr || !connection->ring.write(msg.serializePdu(), (uint32_t) msg.getPduSize())) {
+            if (connection != nullptr) {
+                connection->segment->getHeader().dropped++;
+            }
+            dropped++;
+            return;
+        }
+        internal::ShmSegmentHeader &doorbell = connection->doorbell->getHeader();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (doorbell.sleeping.load(std::memory_order_relaxed)) {
+            doorbell.wakeups.fetch_add(1);
+            internal::futexWake(doorbell.wakeups);
+        }
+    }
+
+    /**
+     * @return The ring of this driver at target, or nullptr if the receiver does not exist or has no free ring.
+     * A connection to a closed segment is replaced, so receivers may come and go.
+     */
+    Connection *connect(uint64_t target) {
+        std::unique_ptr<Connection> &connection = connections[target];
+        if (connection != nullptr && !connection->segment->getHeader().closed.load(std::memory_order_acquire)
+            && !connection->doorbell->getHeader().closed.load(std::memory_order_acquire)) {
+            return connection.get();
+        }
+        connection.reset();
+        std::shared_ptr<internal::ShmSegment> segment = internal::ShmSegment::open(internal::ShmSegment::nameOf(target));
+        if (segment == nullptr) {
+            //like a socket bound to 0.0.0.0, a segment with ip 0 receives everything for its port
+            segment = internal::ShmSegment::open(internal::ShmSegment::nameOf(target & 0xFFFF));
+        }
+        if (segment == nullptr) {
+            return nullptr;
+        }
+        internal::ShmSegmentHeader &header = segment->getHeader();
+        uint64_t producer = mainKey + 1;
+        for (uint32_t i = 0; i < header.numRings; i++) {
+            internal::ShmRing ring = segment->ring(i);
+            uint64_t expected = 0;
+            if (ring.getHeader()->producer.compare_exchange_strong(expected, producer) || expected == producer) {
+                std::shared_ptr<internal::ShmSegment> doorbell = getDoorbell(segment);
+                if (doorbell == nullptr) {
+                    return nullptr;
+                }
+                connection = std::unique_ptr<Connection>(new Connection());
+                connection->ring = ring;
+                connection->doorbell = doorbell;
+                connection->segment = segment;
+                return connection.get();
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<internal::ShmSegment> getDoorbell(const std::shared_ptr<internal::ShmSegment> &segment) {
+        std::string name(segment->getHeader().doorbell);
+        if (name == segment->getName()) {
+            return segment;
+        }
+        std::shared_ptr<internal::ShmSegment> &doorbell = doorbells[name];
+        if (doorbell == nullptr || doorbell->getHeader().closed.load(std::memory_order_acquire)) {
+            doorbell = internal::ShmSegment::open(name);
+        }
+        return doorbell;
+    }
+
+    /**
+     * Wakes the own receive thread, e.g. after the timer was changed.
+     */
+    void ring() {
+        std::lock_guard<std::mutex> lock(mtxReceiving);
+        if (main != nullptr) {
+            main->getHeader().wakeups.fetch_add(1);
+            internal::futexWake(main->getHeader().wakeups);
+        }
+    }
+
+    void startReceiving() {
+        {
+            std::lock_guard<std::mutex> lock(mtxReceiving);
+            main = internal::ShmSegment::create(mainKey, numRings, ringCapacity, internal::ShmSegment::nameOf(mainKey));
+            version++;
+        }
+        if (main == nullptr) {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+            return;
+        }
+        internal::ShmSegmentHeader &doorbell = main->getHeader();
+        std::vector<Receiver> receivers;
+        uint64_t knownVersion = UINT64_MAX;
+        DcpPduSlot slot;
+        while (!stopped.load(std::memory_order_acquire)) {
+            if (knownVersion != version.load(std::memory_order_acquire)) {
+                knownVersion = refresh(receivers);
+            }
+            bool received = false;
+            for (size_t i = 0; i < receivers.size(); i++) {
+                for (internal::ShmRing &ring : receivers[i].rings) {
+                    uint32_t size;
+                    uint8_t *record;
+                    bool corrupt = false;
+                    while ((record = ring.peek(size, corrupt)) != nullptr) {
+                        if (i == 0) {
+                            lastAccess.store(ring.getHeader()->producer.load(std::memory_order_relaxed) - 1,
+                                             std::memory_order_relaxed);
+                        }
+                        DcpPdu &pdu = slot.emplace(record, size);
+                        dcpManager.receive(pdu);
+                        slot.clear();
+                        ring.pop(size);
+                        received = true;
+                    }
+                    if (corrupt) {
+                        dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+                    }
+                }
+            }
+            if (timerArmed.load(std::memory_order_acquire)) {
+                fireTimer();
+            }
+            if (received || busyPoll.load(std::memory_order_relaxed)) {
+                continue;
+            }
+            uint32_t wakeups = doorbell.wakeups.load();
+            doorbell.sleeping.store(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (empty(receivers) && !stopped && knownVersion == version.load()) {
+                sleep(doorbell, wakeups);
+            }
+            doorbell.sleeping.store(0, std::memory_order_relaxed);
+        }
+        //the stop is consumed by this run only, a stop before the loop started is kept
+        stopped = false;
+    }
+
+    /**
+     * Blocks until woken or the armed deadline is reached.
+     */
+    void sleep(internal::ShmSegmentHeader &doorbell, uint32_t wakeups) {
+        std::unique_lock<std::mutex> lock(mtxTimer);
+        if (!timerCallback) {
+            lock.unlock();
+            internal::futexWait(doorbell.wakeups, wakeups, nullptr);
+            return;
+        }
+        std::chrono::nanoseconds remaining = deadline - std::chrono::steady_clock::now();
+        lock.unlock();
+        if (remaining.count() > 0) {
+            struct timespec timeout;
+            timeout.tv_sec = (time_t) (remaining.count() / 1000000000);
+            timeout.tv_nsec = (long) (remaining.count() % 1000000000);
+            internal::futexWait(doorbell.wakeups, wakeups, &timeout);
+        }
+    }
+
+    void fireTimer() {
+        std::function<void()> callback;
+        {
+            std::lock_guard<std::mutex> lock(mtxTimer);
+            if (!timerCallback || std::chrono::steady_clock::now() < deadline) {
+                return;
+            }
+            callback = std::move(timerCallback);
+            timerCallback = nullptr;
+            timerArmed = false;
+        }
+        callback();
+    }
+
+    static bool empty(std::vector<Receiver> &receivers) {
+        for (Receiver &receiver : receivers) {
+            for (internal::ShmRing &ring : receiver.rings) {
+                if (!ring.empty()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Copies the receiving segments for the receive thread. The main segment is always first.
+     * @return version of the copied state
+     */
+    uint64_t refresh(std::vector<Receiver> &receivers) {
+        std::lock_guard<std::mutex> lock(mtxReceiving);
+        receivers.clear();
+        std::vector<std::shared_ptr<internal::ShmSegment>> segments;
+        segments.push_back(main);
+        for (auto &pos : ports) {
+            segments.push_back(pos.second);
+        }
+        for (std::shared_ptr<internal::ShmSegment> &segment : segments) {
+            Receiver receiver;
+            receiver.segment = segment;
+            for (uint32_t i = 0; i < numRings; i++) {
+                receiver.rings.push_back(segment->ring(i));
+            }
+            receivers.push_back(std::move(receiver));
+        }
+        return version.load();
+    }
+
+    void stopReceiving() {
+        stopped = true;
+        ring();
+    }
+
+    void openPorts() {
+        for (auto &pos : ioIn) {
+            openPort(pos.second);
+        }
+        for (auto &pos : paramIn) {
+            openPort(pos.second);
+        }
+    }
+
+    void openPort(uint64_t key) {
+        //the main segment also receives PDUs for its port if it is a wildcard address
+        if (key == mainKey || (mainKey >> 16 == 0 && (mainKey & 0xFFFF) == (key & 0xFFFF))) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtxReceiving);
+        if (ports.count(key)) {
+            return;
+        }
+        std::shared_ptr<internal::ShmSegment> segment = internal::ShmSegment::create(key, numRings, ringCapacity,
+                                                                                      internal::ShmSegment::nameOf(
+                                                                                              mainKey));
+        if (segment == nullptr) {
+            dcpManager.reportError(DcpError::PROTOCOL_ERROR_GENERIC);
+            return;
+        }
+        ports[key] = segment;
+        version++;
+    }
+
+    void closeConfiguredPorts() {
+        {
+            std::lock_guard<std::mutex> lock(mtxReceiving);
+            for (auto &pos : ports) {
+                pos.second->retire();
+            }
+            ports.clear();
+            version++;
+        }
+        ioIn.clear();
+        paramIn.clear();
+    }
+};
+
+#endif //DCPLIB_SHMDRIVER_HPP
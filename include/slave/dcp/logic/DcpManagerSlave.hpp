@@ -13,8 +13,18 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#if defined(__linux__)
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "dcp/logic/AbstractDcpManagerSlave.hpp"
+#include <dcp/helper/StepTimer.hpp>
+#include <dcp/helper/LatencyHistogram.hpp>
 #include <dcp/model/DcpCallbackTypes.hpp>
 
 namespace internal {
@@ -42,8 +52,119 @@ namespace internal {
         std::mutex mtx_;
         std::condition_variable cv_;
     };
+
+    /**
+     * Executes tasks one after another in the order they were posted, on one persistent thread.
+     */
+    struct SerialWorker {
+        SerialWorker(): shutdown_(false), thread_(&SerialWorker::work, this)
+        {}
+
+        ~SerialWorker() {
+            stop();
+        }
+
+        void post(std::function<void()> task) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            tasks_.push_back(std::move(task));
+            lock.unlock();
+            cv_.notify_one();
+        }
+
+        /**
+         * Finishes the running task, discards all queued tasks and ends the thread.
+         */
+        void stop() {
+            std::unique_lock<std::mutex> lock(mtx_);
+            shutdown_ = true;
+            tasks_.clear();
+            lock.unlock();
+            cv_.notify_one();
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+    private:
+        void work() {
+            std::unique_lock<std::mutex> lock(mtx_);
+            while (true) {
+                cv_.wait(lock, [&]{
+                    return shutdown_ || !tasks_.empty();
+                });
+                if (shutdown_) {
+                    return;
+                }
+                std::function<void()> task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+
+        bool shutdown_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::thread thread_;
+    };
+
+    /**
+     * Shared between an object and callbacks that may outlive it. A callback runs its work
+     * through run, which does nothing once the owner called expire.
+     */
+    struct LivenessToken {
+        template<typename F>
+        void run(F work) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (alive_) {
+                work();
+            }
+        }
+
+        /**
+         * Waits for a running callback and disables all later ones.
+         */
+        void expire() {
+            std::lock_guard<std::mutex> lock(mtx_);
+            alive_ = false;
+        }
+
+    private:
+        bool alive_ = true;
+        std::mutex mtx_;
+    };
 }
 
+/**
+ * Reaction of the realtime loop on a step which finished after the start of the following step was due.
+ */
+enum class RealtimeOverrunPolicy {
+    /** Run the delayed steps back-to-back until the schedule is reached again */
+    CATCH_UP,
+    /** Drop the missed steps and continue with the next step on the schedule */
+    SKIP,
+    /** Call the realtime overrun listener and shift the schedule to the current time */
+    DEGRADE,
+};
+
+/**
+ * Phases of a step which are recorded in latency histograms if STEP_METRICS is defined.
+ */
+enum class StepPhase {
+    /** Time between the start of a realtime step being due and the wakeup of the realtime loop */
+    WAKEUP_LATENESS,
+    /** Time a realtime step waits for the input and output locks */
+    LOCK_WAIT,
+    /** Duration of the realtime step callback */
+    STEP_CALLBACK,
+    /** Time to serialize and send the outputs after a realtime step */
+    SEND_OUTPUTS,
+    /** Time between arrival of STC_do_step and sending NTF_state_changed in NRT */
+    NRT_STEP,
+};
+
 /**
  * DCP mangement of an slave
  * @author Christian Kater <kater@sim.uni-hannover.de>
@@ -58,6 +179,7 @@ public:
      */
     DcpManagerSlave(const SlaveDescription_t &dcpSlaveDescription, DcpDriver driver) : AbstractDcpManagerSlave(
             dcpSlaveDescription),
+            semRealtimeStep(0),
             mtxInput(1),
             mtxOutput(1),
             semStopping(0) {
@@ -65,11 +187,15 @@ public:
     }
 
     ~DcpManagerSlave() {
-        delete initializing;
-        delete configuring;
-        delete stopping;
-        delete _doStep;
-        delete running;
+        //the timer cancel below is asynchronous, a queued deadline callback must not reach this slave
+        heartbeatToken->expire();
+        stopRealtimeExecutor();
+        lifecycle.stop();
+        asyncCallbacks.stop();
+        callbackExecutor.stop();
+        if (driver.armTimer) {
+            driver.armTimer(StepTimer::clock::time_point(), nullptr);
+        }
         delete heartbeat;
     }
 
@@ -90,28 +216,93 @@ public:
         if (!(state == DcpState::ALIVE || state == DcpState::CONFIGURATION || state == DcpState::STOPPING ||
               state == DcpState::STOPPED || state == DcpState::ERROR_HANDLING || state == DcpState::ERROR_RESOLVED)) {
             lastExecution++;
-            std::thread *toStop = NULL;
-
-            if (state == DcpState::CONFIGURING) {
-                toStop = configuring;
-            } else if (state == DcpState::INITIALIZING) {
-                toStop = initializing;
-            }
             state = DcpState::STOPPING;
             notifyStateChange();
-            if (stopping != NULL) {
-                stopping->detach();
-                delete stopping;
-            }
-            stopping = new std::thread(&DcpManagerSlave::startStopping, this);
+            lifecycle.post(std::bind(&DcpManagerSlave::startStopping, this));
             return true;
         }
         return false;
     }
 
+    /**
+     * Set the scheduling of the realtime executor thread, which runs all realtime steps in SRT and HRT.
+     * Takes effect with the next STC_run. Only supported on Linux.
+     * @param priority SCHED_FIFO priority of the executor. 0 keeps the default scheduling.
+     * @param cpu CPU the executor is pinned to. -1 disables pinning.
+     */
+    void setRealtimeScheduling(int priority, int cpu) {
+        realtimePriority = priority;
+        realtimeCpu = cpu;
+    }
+
+    /**
+     * Set the timer which waits for the start of each realtime step.
+     * Has to be called before STC_run.
+     */
+    void setStepTimer(std::shared_ptr<StepTimer> stepTimer) {
+        this->stepTimer = stepTimer;
+    }
+
+    /**
+     * @return Timer which waits for the start of each realtime step. Reports the wakeup lateness.
+     */
+    std::shared_ptr<StepTimer> getStepTimer() {
+        return stepTimer;
+    }
+
+    /**
+     * Read the latency histogram of a step phase. The histograms are only recorded if the
+     * library is compiled with STEP_METRICS, otherwise the snapshot is empty.
+     */
+    LatencySnapshot getStepPhaseSnapshot(StepPhase phase) const {
+#if defined(STEP_METRICS)
+        return stepPhaseHistograms[(size_t) phase].snapshot();
+#else
+        (void) phase;
+        return LatencySnapshot();
+#endif
+    }
+
+    /**
+     * Set the reaction on realtime steps which take longer than one step. Default is CATCH_UP.
+     */
+    void setRealtimeOverrunPolicy(RealtimeOverrunPolicy overrunPolicy) {
+        this->overrunPolicy = overrunPolicy;
+    }
+
+    /**
+     * @return Number of realtime steps which finished after the start of the following step was due
+     */
+    uint64_t getMissedRealtimeDeadlines() const {
+        return missedRealtimeDeadlines;
+    }
+
+    /**
+     * @return Number of realtime steps dropped by the overrun policy SKIP
+     */
+    uint64_t getSkippedRealtimeSteps() const {
+        return skippedRealtimeSteps;
+    }
+
+    /**
+     * @return Maximum time in microseconds a realtime step finished after its deadline
+     */
+    int64_t getMaxRealtimeLateness() const {
+        return maxRealtimeLateness;
+    }
+
+    /**
+     * @return Time in microseconds the step schedule was shifted by the overrun policies SKIP and DEGRADE
+     */
+    int64_t getRealtimeDrift() const {
+        return realtimeDrift;
+    }
+
     DcpManager getDcpManager() override {
+        //inputs are decoded before receive returns, so the slave never keeps a receive buffer
         return {[this](DcpPdu &msg) { receive(msg); },
-                [this](const DcpError errorCode) { reportError(errorCode); }};
+                [this](const DcpError errorCode) { reportError(errorCode); },
+                nullptr};
     }
 
     /**
@@ -470,6 +661,17 @@ public:
         asynchronousCallback[DcpCallbackTypes::RUNTIME] = ftype == ASYNC;
     }
 
+    /**
+    * Set the listener for realtime steps which overran their deadline. Only called with the overrun policy DEGRADE.
+    * @tparam ftype SYNC means calling the given function is blocking, ASYNC means non blocking
+    * @param realtimeOverrunListener function which will be called with the lateness in microseconds
+    */
+    template<FunctionType ftype>
+    void setRealtimeOverrunListener(const std::function<void(int64_t)> realtimeOverrunListener) {
+        this->realtimeOverrunListener = std::move(realtimeOverrunListener);
+        asynchronousCallback[DcpCallbackTypes::REALTIME_OVERRUN] = ftype == ASYNC;
+    }
+
     /**
     * Set the listener for state changes which was made by the dcp slave manager
     * @tparam ftype SYNC means calling the given function is blocking, ASYNC means non blocking
@@ -512,6 +714,7 @@ private:
     std::function<void(uint64_t valueReference)> inputOutputUpdateListener = [](uint64_t valueReference) {};
     std::function<void(int64_t unixTimeStamp)> runtimeListener = [](int64_t unixTimeStamp) {};
     std::function<void(DcpState state)> stateChangedListener = [](DcpState state) {};
+    std::function<void(int64_t lateness)> realtimeOverrunListener = [](int64_t) {};
 
 
 protected:
@@ -521,15 +724,47 @@ protected:
      * state change has happened and the done calculations are
      * obsolete.
      */
-    int lastExecution;
-    std::thread *initializing = NULL;
-    std::thread *synchronizing = NULL;
-    std::thread *configuring = NULL;
-    std::thread *preparing = NULL;
-    std::thread *stopping = NULL;
-    std::thread *_doStep = NULL;
-    std::thread *running = NULL;
+    std::atomic_int lastExecution{0};
+    /**
+     * Runs prepare, configure, initialize, synchronize, NRT steps and stop.
+     */
+    internal::SerialWorker lifecycle;
+    /**
+     * Runs ASYNC lifecycle and step callbacks, apart from the listeners on the callback executor.
+     */
+    internal::SerialWorker asyncCallbacks;
     std::thread *heartbeat = NULL;
+    //guards the deadline callbacks armed on the driver against running after destruction
+    std::shared_ptr<internal::LivenessToken> heartbeatToken = std::make_shared<internal::LivenessToken>();
+
+    /* Realtime executor */
+    std::thread *realtimeExecutor = NULL;
+    std::mutex mtxRealtime;
+    std::condition_variable cvRealtime;
+    bool realtimeStartPending = false;
+    bool realtimeActive = false;
+    int64_t realtimeStartTime = 0;
+    std::atomic_bool realtimeShutdown{false};
+    internal::Semaphore semRealtimeStep;
+    std::atomic_int realtimePriority{0};
+    std::atomic_int realtimeCpu{-1};
+    std::atomic<RealtimeOverrunPolicy> overrunPolicy{RealtimeOverrunPolicy::CATCH_UP};
+    std::atomic<uint64_t> missedRealtimeDeadlines{0};
+    std::atomic<uint64_t> skippedRealtimeSteps{0};
+    std::atomic<int64_t> maxRealtimeLateness{0};
+    std::atomic<int64_t> realtimeDrift{0};
+#if defined(STEP_METRICS)
+    LatencyHistogram stepPhaseHistograms[(size_t) StepPhase::NRT_STEP + 1];
+    StepTimer::clock::time_point stepCallbackStart;
+    StepTimer::clock::time_point nrtStepArrival;
+#endif
+#if defined(__linux__)
+    cpu_set_t defaultCpus;
+#endif
+
+    enum class RealtimeStep {
+        NONE, FINISHED, PENDING
+    };
 
     /* Mutex */
     internal::Semaphore mtxInput;
@@ -537,13 +772,15 @@ protected:
     internal::Semaphore semStopping;
     std::atomic_bool should_stop{false};
 
-    std::mutex mtxHeartbeat;
     std::mutex mtxParam;
     std::mutex mtxLog;
 
     /* Time Handling */
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds> lastStateRequest;
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds> nextCommunication;
+    //time since epoch of the last control PDU from the master, written without lock by the receive thread
+    std::atomic<StepTimer::clock::rep> lastStateRequest{0};
+    StepTimer::clock::time_point nextCommunication;
+    std::shared_ptr<StepTimer> stepTimer = std::make_shared<StepTimer>();
+    StepTimer heartbeatTimer;
 
 
 
@@ -566,18 +803,33 @@ protected:
         }
     }
 
+    /**
+     * Queues a lifecycle routine. The routine is skipped if another state change
+     * was requested before it is executed.
+     */
+    void postLifecycleTask(std::function<void()> routine) {
+        int execution = lastExecution;
+        lifecycle.post([this, execution, routine] {
+            if (execution == lastExecution) {
+                routine();
+            }
+        });
+    }
+
+    /**
+     * Runs an ASYNC lifecycle or step callback on the async callback worker, never on the calling thread.
+     */
+    void postAsyncCallback(std::function<void()> callback) {
+        asyncCallbacks.post(std::move(callback));
+    }
+
     /**************************
     *  Prepare
     **************************/
 
     virtual void prepare() override {
         lastExecution++;
-        if (preparing != NULL) {
-            preparing->detach();
-            delete preparing;
-
-        }
-        preparing = new std::thread(&DcpManagerSlave::startPreparing, this);
+        postLifecycleTask(std::bind(&DcpManagerSlave::startPreparing, this));
     }
 
     void startPreparing() {
@@ -585,8 +837,7 @@ protected:
         Log(PREPARING_STARTED);
 #endif
         if (asynchronousCallback[DcpCallbackTypes::PREPARE]) {
-            std::thread t(prepareCallback);
-            t.detach();
+            postAsyncCallback(prepareCallback);
         } else {
             prepareCallback();
             preparingFinished();
@@ -605,11 +856,7 @@ protected:
     virtual void configure() override {
         should_stop = false;
         lastExecution++;
-        if (configuring != NULL) {
-            configuring->detach();
-            delete configuring;
-        }
-        configuring = new std::thread(&DcpManagerSlave::startConfiguring, this);
+        postLifecycleTask(std::bind(&DcpManagerSlave::startConfiguring, this));
     }
 
     void startConfiguring() {
@@ -617,8 +864,7 @@ protected:
         Log(CONFIGURING_STARTED);
 #endif
         if (asynchronousCallback[DcpCallbackTypes::CONFIGURE]) {
-            std::thread t(configureCallback);
-            t.detach();
+            postAsyncCallback(configureCallback);
         } else {
             configureCallback();
             configuringFinished();
@@ -636,11 +882,7 @@ protected:
 
     virtual void initialize() override {
         lastExecution++;
-        if (initializing != NULL) {
-            initializing->detach();
-            delete initializing;
-        }
-        initializing = new std::thread(&DcpManagerSlave::startInitializing, this);
+        postLifecycleTask(std::bind(&DcpManagerSlave::startInitializing, this));
     }
 
     void startInitializing() {
@@ -649,8 +891,7 @@ protected:
 #endif
 
         if (asynchronousCallback[DcpCallbackTypes::INITIALIZE]) {
-            std::thread t(initializeCallback);
-            t.detach();
+            postAsyncCallback(initializeCallback);
         } else {
             initializeCallback();
             initializingFinished();
@@ -667,11 +908,7 @@ protected:
 
     virtual void synchronize() override {
         lastExecution++;
-        if (synchronizing != NULL) {
-            synchronizing->detach();
-            delete synchronizing;
-        }
-        synchronizing = new std::thread(&DcpManagerSlave::startSynchronizing, this);
+        postLifecycleTask(std::bind(&DcpManagerSlave::startSynchronizing, this));
     }
 
     void startSynchronizing() {
@@ -680,8 +917,7 @@ protected:
 #endif
 
         if (asynchronousCallback[DcpCallbackTypes::synchronize]) {
-            std::thread t(synchronizeCallback);
-            t.detach();
+            postAsyncCallback(synchronizeCallback);
         } else {
             synchronizeCallback();
             synchronizingFinished();
@@ -709,12 +945,10 @@ protected:
     **************************/
 
     virtual void doStep(const uint32_t steps) override {
-        if (_doStep != NULL) {
-            _doStep->detach();
-            delete _doStep;
-        }
-        _doStep = new std::thread(&DcpManagerSlave::startComputing, this,
-                                  steps);
+#if defined(STEP_METRICS)
+        nrtStepArrival = StepTimer::clock::now();
+#endif
+        postLifecycleTask(std::bind(&DcpManagerSlave::startComputing, this, steps));
     }
 
     void startComputing(uint32_t steps) {
@@ -726,12 +960,12 @@ protected:
             semStopping.post();
             return;
         }
+        loadInputSnapshot();
 
         switch (runLastExitPoint) {
             case DcpState::RUNNING: {
 		    if (asynchronousCallback[DcpCallbackTypes::RUNNING_NRT_STEP]) {
-			std::thread t(runningNRTStepCallback, steps);
-			t.detach();
+			postAsyncCallback(std::bind(runningNRTStepCallback, steps));
 		    } else {
 			runningNRTStepCallback(steps);
 			computingFinished();
@@ -740,8 +974,7 @@ protected:
             }
             case DcpState::SYNCHRONIZING: {
                 if (asynchronousCallback[DcpCallbackTypes::SYNCHRONIZING_NRT_STEP]) {
-                    std::thread t(synchronizingNRTStepCallback, steps);
-                    t.detach();
+                    postAsyncCallback(std::bind(synchronizingNRTStepCallback, steps));
                 } else {
                     synchronizingNRTStepCallback(steps);
                     computingFinished();
@@ -750,8 +983,7 @@ protected:
             }
             case DcpState::SYNCHRONIZED: {
                 if (asynchronousCallback[DcpCallbackTypes::SYNCHRONIZED_NRT_STEP]) {
-                    std::thread t(synchronizedNRTStepCallback, steps);
-                    t.detach();
+                    postAsyncCallback(std::bind(synchronizedNRTStepCallback, steps));
                 } else {
                     synchronizedNRTStepCallback(steps);
                     computingFinished();
@@ -767,6 +999,9 @@ protected:
 
     virtual void computingFinished() {
         routineFinished<DcpState::COMPUTING, DcpState::COMPUTED>(COMPUTING_FINISHED, COMPUTING_INTERRUPTED);
+#if defined(STEP_METRICS)
+        recordStepPhase(StepPhase::NRT_STEP, nrtStepArrival);
+#endif
     }
 
     /**************************
@@ -774,87 +1009,182 @@ protected:
     **************************/
 
     virtual void run(const int64_t startTime) override {
-        if (running != NULL) {
-            running->detach();
-            delete running;
+        std::unique_lock<std::mutex> lock(mtxRealtime);
+        if (realtimeExecutor == NULL) {
+            realtimeExecutor = new std::thread(&DcpManagerSlave::realtimeRoutine, this);
+        }
+        if (realtimeActive) {
+            //SYNCHRONIZED -> RUNNING: the executor is already stepping and takes over the state with the next step
+            return;
+        }
+        realtimeStartTime = startTime;
+        realtimeStartPending = true;
+        lock.unlock();
+        cvRealtime.notify_one();
+    }
+
+    /**
+     * Body of the realtime executor. Waits for STC_run and executes the realtime steps
+     * until the realtime states are left, then waits for the next STC_run.
+     */
+    void realtimeRoutine() {
+#if defined(__linux__)
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &defaultCpus);
+#endif
+        std::unique_lock<std::mutex> lock(mtxRealtime);
+        while (true) {
+            cvRealtime.wait(lock, [this] { return realtimeShutdown || realtimeStartPending; });
+            if (realtimeShutdown) {
+                return;
+            }
+            realtimeStartPending = false;
+            realtimeActive = true;
+            int64_t startTime = realtimeStartTime;
+            lock.unlock();
+
+            applyRealtimeScheduling();
+            startRealtime(startTime);
+
+            lock.lock();
+            realtimeActive = false;
+        }
+    }
+
+    void stopRealtimeExecutor() {
+        {
+            std::unique_lock<std::mutex> lock(mtxRealtime);
+            realtimeShutdown = true;
+        }
+        cvRealtime.notify_one();
+        semRealtimeStep.post();
+        if (realtimeExecutor != NULL) {
+            realtimeExecutor->join();
+            delete realtimeExecutor;
+            realtimeExecutor = NULL;
         }
-        running = new std::thread(&DcpManagerSlave::startRealtime,
-                                  this, startTime);
+    }
+
+    void applyRealtimeScheduling() {
+#if defined(__linux__)
+        int result;
+        sched_param param;
+        if (realtimePriority > 0) {
+            param.sched_priority = realtimePriority;
+            result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        } else {
+            param.sched_priority = 0;
+            result = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+        }
+        if (result != 0) {
+#if defined(DEBUG) || defined(LOGGING)
+            Log(REALTIME_SCHEDULING_FAILED, std::string(strerror(result)));
+#endif
+        }
+        cpu_set_t cpus = defaultCpus;
+        if (realtimeCpu >= 0) {
+            CPU_ZERO(&cpus);
+            CPU_SET(realtimeCpu, &cpus);
+        }
+        result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+        if (result != 0) {
+#if defined(DEBUG) || defined(LOGGING)
+            Log(REALTIME_SCHEDULING_FAILED, std::string(strerror(result)));
+#endif
+        }
+#endif
     }
 
     void startRealtime(int64_t startTime) {
         using namespace std::chrono;
+        missedRealtimeDeadlines = 0;
+        skippedRealtimeSteps = 0;
+        maxRealtimeLateness = 0;
+        realtimeDrift = 0;
         if (startTime == 0) {
-            nextCommunication = time_point_cast<microseconds>(system_clock::now());
+            nextCommunication = StepTimer::clock::now();
         } else {
-            nextCommunication = time_point<system_clock, microseconds>(
-                    seconds(startTime));
-            std::this_thread::sleep_until(nextCommunication);
+            nextCommunication = StepTimer::fromSystemTime(system_clock::time_point(seconds(startTime)));
+            stepTimer->waitUntil(nextCommunication);
         }
 
         if(state == DcpState::SYNCHRONIZING){
             realtimeState = state;
-            startRealtimeStep();
+            RealtimeStep step = startRealtimeStep();
             synchronize();
+            while (step != RealtimeStep::NONE) {
+                if (step == RealtimeStep::PENDING) {
+                    semRealtimeStep.wait();
+                    if (realtimeShutdown) {
+                        return;
+                    }
+                }
+#if defined(STEP_METRICS)
+                recordStepPhase(StepPhase::STEP_CALLBACK, stepCallbackStart);
+#endif
+                completeRealtimeStep();
+                realtimeState = state;
+                step = startRealtimeStep();
+            }
         } else if(state == DcpState::RUNNING){
             realtimeState = state;
         }
     }
 
-    void startRealtimeStep() {
+    /**
+     * Executes the step callback for the current realtime state.
+     * @return NONE if no step was started and the realtime routine ends, FINISHED if the step is
+     * done and PENDING if an ASYNC callback was started, which signals its end with realtimeStepFinished.
+     */
+    RealtimeStep startRealtimeStep() {
         using namespace std::chrono;
 
         uint32_t steps = 1;
 
         if (should_stop) {
             semStopping.post();
-            return;
+            return RealtimeStep::NONE;
+        }
+        if (realtimeShutdown) {
+            return RealtimeStep::NONE;
         }
 
         switch (realtimeState) {
             case DcpState::RUNNING: {
                 if (state == DcpState::RUNNING) {
-                    mtxInput.wait();
-                    mtxOutput.wait();
+                    acquireStepLocks();
 
                     if (asynchronousCallback[DcpCallbackTypes::RUNNING_STEP]) {
-                        std::thread t(runningStepCallback, steps);
-                        t.detach();
+                        postAsyncCallback(std::bind(runningStepCallback, steps));
+                        return RealtimeStep::PENDING;
                     } else {
                         runningStepCallback(steps);
-                        std::thread t(&DcpManagerSlave::realtimeStepFinished, this);
-                        t.detach();
+                        return RealtimeStep::FINISHED;
                     }
                 }
                 break;
             }
             case DcpState::SYNCHRONIZING: {
-                mtxInput.wait();
-                mtxOutput.wait();
+                acquireStepLocks();
 
                 if (asynchronousCallback[DcpCallbackTypes::SYNCHRONIZING_STEP]) {
-                    std::thread t(synchronizingStepCallback, steps);
-                    t.detach();
+                    postAsyncCallback(std::bind(synchronizingStepCallback, steps));
+                    return RealtimeStep::PENDING;
                 } else {
                     synchronizingStepCallback(steps);
-                    std::thread t(&DcpManagerSlave::realtimeStepFinished, this);
-                    t.detach();
+                    return RealtimeStep::FINISHED;
                 }
-                break;
             }
             case DcpState::SYNCHRONIZED: {
                 if (state == DcpState::RUNNING || state == DcpState::SYNCHRONIZED) {
-                    mtxInput.wait();
-                    mtxOutput.wait();
+                    acquireStepLocks();
 
                     if (asynchronousCallback[DcpCallbackTypes::SYNCHRONIZED_STEP]) {
-                        std::thread t(synchronizedStepCallback, steps);
-                        t.detach();
+                        postAsyncCallback(std::bind(synchronizedStepCallback, steps));
+                        return RealtimeStep::PENDING;
                     }
                     else {
                         synchronizedStepCallback(steps);
-                        std::thread t(&DcpManagerSlave::realtimeStepFinished, this);
-                        t.detach();
+                        return RealtimeStep::FINISHED;
                     }
                 }
                 break;
@@ -864,9 +1194,45 @@ protected:
                 break;
             }
         }
+        return RealtimeStep::NONE;
     }
 
+    void acquireStepLocks() {
+#if defined(STEP_METRICS)
+        StepTimer::clock::time_point start = StepTimer::clock::now();
+#endif
+        mtxInput.wait();
+        mtxOutput.wait();
+        loadInputSnapshot();
+#if defined(STEP_METRICS)
+        stepCallbackStart = StepTimer::clock::now();
+        stepPhaseHistograms[(size_t) StepPhase::LOCK_WAIT].record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(stepCallbackStart - start).count());
+#endif
+    }
+
+#if defined(STEP_METRICS)
+    void recordStepPhase(StepPhase phase, StepTimer::clock::time_point since) {
+        stepPhaseHistograms[(size_t) phase].record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(StepTimer::clock::now() - since).count());
+    }
+#endif
+
+    /**
+     * Signals the realtime executor that an ASYNC step callback is done.
+     */
     virtual void realtimeStepFinished() {
+        semRealtimeStep.post();
+    }
+
+    /**
+     * Sends the due outputs of the finished step and waits for the start of the next step.
+     */
+    void completeRealtimeStep() {
+        using namespace std::chrono;
+#if defined(STEP_METRICS)
+        StepTimer::clock::time_point sendStart = StepTimer::clock::now();
+#endif
         mtxInput.post();
         uint32_t steps = 1;
 
@@ -878,43 +1244,90 @@ protected:
             }
         }
         mtxOutput.post();
+#if defined(STEP_METRICS)
+        recordStepPhase(StepPhase::SEND_OUTPUTS, sendStart);
+#endif
 
-        nextCommunication += std::chrono::microseconds((int64_t) ((((double) numerator) / ((double) denominator)
-                                                                   * ((double) steps)) * 1000000.0));
+        nanoseconds period((int64_t) ((((double) numerator) / ((double) denominator)
+                                       * ((double) steps)) * 1000000000.0));
+        nextCommunication += period;
         //steps = newSteps;
-        std::this_thread::sleep_until(nextCommunication);
-        realtimeState = state;
-        startRealtimeStep();
+        StepTimer::clock::time_point now = StepTimer::clock::now();
+        if (now > nextCommunication) {
+            handleRealtimeOverrun(now, period);
+        }
+#if defined(STEP_METRICS)
+        stepPhaseHistograms[(size_t) StepPhase::WAKEUP_LATENESS].record(stepTimer->waitUntil(nextCommunication).count());
+#else
+        stepTimer->waitUntil(nextCommunication);
+#endif
+    }
+
+    void handleRealtimeOverrun(StepTimer::clock::time_point now, std::chrono::nanoseconds period) {
+        using namespace std::chrono;
+        int64_t lateness = duration_cast<microseconds>(now - nextCommunication).count();
+        missedRealtimeDeadlines++;
+        if (lateness > maxRealtimeLateness) {
+            maxRealtimeLateness = lateness;
+        }
+#ifdef DEBUG
+        Log(REALTIME_DEADLINE_MISSED, lateness);
+#endif
+        switch (overrunPolicy) {
+            case RealtimeOverrunPolicy::CATCH_UP:
+                break;
+            case RealtimeOverrunPolicy::SKIP: {
+                int64_t missed = (now - nextCommunication) / period + 1;
+                nextCommunication += missed * period;
+                skippedRealtimeSteps += missed;
+                realtimeDrift += duration_cast<microseconds>(missed * period).count();
+                break;
+            }
+            case RealtimeOverrunPolicy::DEGRADE:
+                nextCommunication = now;
+                realtimeDrift += lateness;
+                notifyRealtimeOverrunListener(lateness);
+                break;
+        }
     }
 
 
     virtual void sendOutputs(std::vector<dataId_t> dataIdsToSend) override {
+        std::lock_guard<std::mutex> lock(sendOutputsMutex);
+        if (!outputEncodePlansValid) {
+            buildOutputEncodePlans();
+        }
+        pdusToSend.clear();
         for (dataId_t dataId  : dataIdsToSend) {
-            if (outputAssignment.find(dataId) == outputAssignment.end()) {
+            if (dataId >= outputEncodePlans.size() || outputEncodePlans[dataId].pdu == nullptr) {
                 continue;
             }
-            DcpPduDatInputOutput *pdu = outputBuffer[dataId];
-            size_t offset = 0;
-
-            std::map<uint16_t, uint64_t> vrsToSend = outputAssignment[dataId];
-            for (uint16_t i = 0; i < vrsToSend.size(); i++) {
-                uint64_t vr = vrsToSend[i];
-
-                offset += values[vr]->serialize(pdu->getPayload(), offset);
-
-            }
+            const OutputEncodePlan &plan = outputEncodePlans[dataId];
+            DcpPduDatInputOutput *pdu = plan.pdu;
+            size_t offset = applyOutputEncodePlan(plan);
             pdu->getPduSeqId() = getNextDataSeqNum(pdu->getDataId());
             pdu->setPduSize(offset + 5);
 
-            driver.send(*pdu);
+            pdusToSend.push_back(pdu);
+        }
+        if (pdusToSend.empty()) {
+            return;
+        }
+        if (driver.sendBatch) {
+            driver.sendBatch(pdusToSend);
+        } else {
+            for (DcpPdu *pdu : pdusToSend) {
+                driver.send(*pdu);
+            }
         }
     }
 
     virtual void updateLastStateRequest() override {
-        mtxHeartbeat.lock();
-        lastStateRequest = std::chrono::time_point_cast<std::chrono::microseconds>(
-                std::chrono::system_clock::now());
-        mtxHeartbeat.unlock();
+        lastStateRequest.store(StepTimer::clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    StepTimer::clock::time_point getLastStateRequest() const {
+        return StepTimer::clock::time_point(StepTimer::clock::duration(lastStateRequest.load(std::memory_order_relaxed)));
     }
 
     /**************************
@@ -927,8 +1340,7 @@ protected:
         Log(STOPPING_STARTED);
 #endif
         if (asynchronousCallback[DcpCallbackTypes::STOP]) {
-            std::thread t(stopCallback);
-            t.detach();
+            postAsyncCallback(stopCallback);
         } else {
             stopCallback();
             stoppingFinished();
@@ -955,6 +1367,15 @@ protected:
 #endif
                 return;
             }
+            updateLastStateRequest();
+            if (driver.armTimer) {
+                //re-arming replaces the deadline of a previous supervision
+#ifdef DEBUG
+                Log(HEARTBEAT_STARTED);
+#endif
+                driver.armTimer(StepTimer::clock::now(), heartbeatDeadlineCallback());
+                return;
+            }
             if (heartbeat != NULL) {
                 heartbeat->detach();
                 delete heartbeat;
@@ -963,48 +1384,80 @@ protected:
         }
     }
 
+    std::function<void()> heartbeatDeadlineCallback() {
+        std::shared_ptr<internal::LivenessToken> token = heartbeatToken;
+        return [this, token] {
+            token->run([this] { heartbeatDeadline(); });
+        };
+    }
+
+    /**
+     * Supervises the heartbeat on the receive thread of the driver. Re-arms the deadline
+     * timer of the driver as long as the heartbeat is monitored.
+     */
+    void heartbeatDeadline() {
+        if (heartbeatMonitored()) {
+            StepTimer::clock::time_point nextCheck = checkHeartbeat();
+            if (heartbeatMonitored()) {
+                driver.armTimer(nextCheck, heartbeatDeadlineCallback());
+                return;
+            }
+        }
+#ifdef DEBUG
+        Log(HEARTBEAT_STOPPED);
+#endif
+    }
+
+    /**
+     * Supervises the heartbeat on an own thread, for drivers without deadline timer.
+     */
     void heartBeat() {
-        using namespace std::chrono;
 #ifdef DEBUG
         Log(HEARTBEAT_STARTED);
 #endif
+        while (heartbeatMonitored()) {
+            StepTimer::clock::time_point nextCheck = checkHeartbeat();
+            if (heartbeatMonitored()) {
+                heartbeatTimer.waitUntil(nextCheck);
+            }
+        }
+#ifdef DEBUG
+        Log(HEARTBEAT_STOPPED);
+#endif
+    }
+
+    bool heartbeatMonitored() {
+        return !(state == DcpState::ALIVE || state == DcpState::ERROR_HANDLING || state == DcpState::ERROR_RESOLVED);
+    }
+
+    /**
+     * Goes to error handling if the maximum periodic interval since the last state request is over.
+     * @return Time of the next check
+     */
+    StepTimer::clock::time_point checkHeartbeat() {
+        using namespace std::chrono;
         MaximumPeriodicInterval_t &interval = slaveDescription.Heartbeat->MaximumPeriodicInterval;
         uint32_t numerator = interval.numerator;
         uint32_t denominator = interval.denominator;
-        time_point<system_clock, microseconds> now;
-        mtxHeartbeat.lock();
-        lastStateRequest = time_point_cast<microseconds>(system_clock::now());
-        mtxHeartbeat.unlock();
-        while (!(state == DcpState::ALIVE || state == DcpState::ERROR_HANDLING || state == DcpState::ERROR_RESOLVED)) {
-            now = time_point_cast<microseconds>(system_clock::now());
-
-            mtxHeartbeat.lock();
-            auto between = duration_cast<microseconds>(now - lastStateRequest).count();
-            mtxHeartbeat.unlock();
-            if (between * denominator >= numerator * 1000000) {
+        StepTimer::clock::time_point now = StepTimer::clock::now();
+        StepTimer::clock::time_point last = getLastStateRequest();
+        int64_t between = duration_cast<microseconds>(now - last).count();
+        if (between * denominator >= (int64_t) numerator * 1000000) {
 #ifdef DEBUG
-                Log(HEARTBEAT_MISSED, to_string(now), to_string(lastStateRequest));
+            Log(HEARTBEAT_MISSED, to_string(StepTimer::toSystemTime(now)),
+                to_string(StepTimer::toSystemTime(last)));
 #endif
-                errorCode = DcpError::PROTOCOL_ERROR_HEARTBEAT_MISSED;
-                gotoErrorHandling();
-                gotoErrorResolved();
-            } else {
-                mtxHeartbeat.lock();
-                time_point<system_clock, microseconds> nextCheck = lastStateRequest + microseconds(
-                        (int64_t) (1000000 * ((double) numerator) / ((double) denominator)));
-                mtxHeartbeat.unlock();
-                std::this_thread::sleep_until(nextCheck);
-            }
+            errorCode = DcpError::PROTOCOL_ERROR_HEARTBEAT_MISSED;
+            gotoErrorHandling();
+            gotoErrorResolved();
+            return now;
         }
-#ifdef DEBUG
-        Log(HEARTBEAT_STOPPED);
-#endif
+        return last + microseconds((int64_t) (1000000 * ((double) numerator) / ((double) denominator)));
     }
 
     virtual void notifyStateChangedListener() override {
         if (asynchronousCallback[DcpCallbackTypes::STATE_CHANGED]) {
-            std::thread t(stateChangedListener, state);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::STATE_CHANGED, std::bind(stateChangedListener, state));
         } else {
             stateChangedListener(state);
         }
@@ -1012,8 +1465,7 @@ protected:
 
     virtual void notifyTimeResListener() override {
         if (asynchronousCallback[DcpCallbackTypes::TIME_RES]) {
-            std::thread t(timeResListener, numerator, denominator);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::TIME_RES, std::bind(timeResListener, numerator, denominator));
         } else {
             timeResListener(numerator, denominator);
         }
@@ -1021,8 +1473,7 @@ protected:
 
     virtual void notifyStepsListener(uint16_t dataId, uint32_t steps) override {
         if (asynchronousCallback[DcpCallbackTypes::STEPS]) {
-            std::thread t(stepsListener, dataId, steps);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::STEPS, std::bind(stepsListener, dataId, steps));
         } else {
             stepsListener(dataId, steps);
         }
@@ -1030,17 +1481,24 @@ protected:
 
     virtual void notifyOperationInformationListener() override {
         if (asynchronousCallback[DcpCallbackTypes::OPERATION_INFORMATION]) {
-            std::thread t(operationInformationListener, dcpId, opMode);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::OPERATION_INFORMATION,
+                                  std::bind(operationInformationListener, dcpId, opMode));
         } else {
             operationInformationListener(dcpId, opMode);
         }
     }
 
+    void notifyRealtimeOverrunListener(int64_t lateness) {
+        if (asynchronousCallback[DcpCallbackTypes::REALTIME_OVERRUN]) {
+            callbackExecutor.post(DcpCallbackTypes::REALTIME_OVERRUN, std::bind(realtimeOverrunListener, lateness));
+        } else {
+            realtimeOverrunListener(lateness);
+        }
+    }
+
     virtual void notifyRuntimeListener(int64_t unixTimeStamp) override {
         if (asynchronousCallback[DcpCallbackTypes::RUNTIME]) {
-            std::thread t(runtimeListener, unixTimeStamp);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::RUNTIME, std::bind(runtimeListener, unixTimeStamp));
         } else {
             runtimeListener(unixTimeStamp);
         }
@@ -1048,8 +1506,7 @@ protected:
 
     virtual void notifyMissingControlPduListener() override {
         if (asynchronousCallback[DcpCallbackTypes::CONTROL_MISSED]) {
-            std::thread t(missingControlPduListener);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::CONTROL_MISSED, std::bind(missingControlPduListener));
         } else {
             missingControlPduListener();
         }
@@ -1057,8 +1514,8 @@ protected:
 
     virtual void notifyMissingInputOutputPduListener(uint16_t dataId) override {
         if (asynchronousCallback[DcpCallbackTypes::IN_OUT_MISSED]) {
-            std::thread t(missingInputOutputPduListener, dataId);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::IN_OUT_MISSED,
+                                  std::bind(missingInputOutputPduListener, dataId));
         } else {
             missingInputOutputPduListener(dataId);
         }
@@ -1066,8 +1523,7 @@ protected:
 
     virtual void notifyMissingParameterPduListener(uint16_t paramId) override {
         if (asynchronousCallback[DcpCallbackTypes::CONTROL_MISSED]) {
-            std::thread t(missingParameterPduListener, paramId);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::PARAM_MISSED, std::bind(missingParameterPduListener, paramId));
         } else {
             missingParameterPduListener(paramId);
         }
@@ -1075,8 +1531,8 @@ protected:
 
     virtual void notifyInputOutputUpdateListener(uint64_t valueReference) override {
         if (asynchronousCallback[DcpCallbackTypes::IN_OUT_UPDATE]) {
-            std::thread t(inputOutputUpdateListener, valueReference);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::IN_OUT_UPDATE,
+                                  std::bind(inputOutputUpdateListener, valueReference));
         } else {
             inputOutputUpdateListener(valueReference);
         }
@@ -1084,8 +1540,7 @@ protected:
 
     virtual void reportError(const DcpError errorCode) override {
         if (asynchronousCallback[DcpCallbackTypes::ERROR_LI]) {
-            std::thread t(errorListener, errorCode);
-            t.detach();
+            callbackExecutor.post(DcpCallbackTypes::ERROR_LI, std::bind(errorListener, errorCode));
         } else {
             errorListener(errorCode);
         }
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+/*
+ * Sends DAT_input_output PDUs at fixed rates from one driver to another over the loopback interface
+ * and compares UdpDriver with UringUdpDriver in loss, one way latency and CPU time per PDU.
+ * Usage: driverbenchmark [seconds per run] [--sqpoll]
+ */
+
+//the per PDU debug output would dominate the measurement
+#undef DEBUG
+#ifndef LOGGING
+#define LOGGING
+#endif
+
+#include <dcp/driver/ethernet/udp/UdpDriver.hpp>
+#include <dcp/driver/ethernet/udp/UringUdpDriver.hpp>
+#include <dcp/helper/LatencyHistogram.hpp>
+#include <dcp/model/pdu/DcpPduDatInputOutput.hpp>
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+static const ip_address_t LOCALHOST = 0x7F000001;
+static const dataId_t DATA_ID = 1;
+static const uint16_t PAYLOAD_SIZE = 16;
+
+struct Result {
+    uint64_t sent = 0;
+    uint64_t received = 0;
+    uint64_t errors = 0;
+    LatencySnapshot latency;
+    double senderCpu = 0;
+    double receiverCpu = 0;
+};
+
+static double threadCpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+           + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+static LogManager silentLogManager() {
+    LogManager logManager;
+    logManager.alloc = [](size_t size) {
+        static thread_local std::vector<uint8_t> buffer;
+        buffer.resize(size);
+        return buffer.data();
+    };
+    logManager.consume = [](const LogTemplate &, uint8_t *, size_t) {};
+    return logManager;
+}
+
+/**
+ * Runs sender and receiver for the given time. Every millisecond rate / 1000 PDUs are sent,
+ * with sendBatch in chunks of batchSize, or one by one with send if batchSize is 1.
+ */
+static Result run(DcpDriver sender, DcpDriver receiver, uint32_t rate, size_t batchSize, double seconds) {
+    Result result;
+    LatencyHistogram histogram;
+    std::atomic<uint64_t> received(0);
+    std::atomic<uint64_t> errors(0);
+    double receiverCpu = 0;
+
+    DcpManager receiverManager;
+    receiverManager.receive = [&histogram, &received](DcpPdu &pdu) {
+        if (pdu.getTypeId() != DcpPduType::DAT_input_output) {
+            return;
+        }
+        int64_t sentAt;
+        std::memcpy(&sentAt, static_cast<DcpPduDatInputOutput &>(pdu).getPayload(), sizeof(sentAt));
+        histogram.record(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() - sentAt);
+        received.fetch_add(1, std::memory_order_relaxed);
+    };
+    receiverManager.reportError = [&errors](DcpError) { errors++; };
+    DcpManager senderManager;
+    senderManager.receive = [](DcpPdu &) {};
+    senderManager.reportError = [&errors](DcpError) { errors++; };
+
+    LogManager logManager = silentLogManager();
+    sender.setLogManager(logManager);
+    receiver.setLogManager(logManager);
+    sender.setDcpManager(senderManager);
+    receiver.setDcpManager(receiverManager);
+
+    std::thread receiverThread([&receiver, &receiverCpu] {
+        receiver.startReceiving();
+        receiverCpu = threadCpuSeconds();
+    });
+    std::thread senderThread([&sender] { sender.startReceiving(); });
+    std::this_thread::sleep_for(milliseconds(200));
+
+    std::vector<std::unique_ptr<DcpPduDatInputOutput>> pdus;
+    std::vector<DcpPdu *> batch;
+    for (size_t i = 0; i < batchSize; i++) {
+        pdus.emplace_back(new DcpPduDatInputOutput(0, DATA_ID, PAYLOAD_SIZE));
+        std::memset(pdus.back()->getPayload(), 0, PAYLOAD_SIZE);
+    }
+    uint32_t perTick = rate / 1000;
+    uint64_t ticks = (uint64_t) (seconds * 1000);
+    uint16_t seqId = 0;
+    double senderCpu = threadCpuSeconds();
+    steady_clock::time_point next = steady_clock::now();
+    for (uint64_t tick = 0; tick < ticks; tick++) {
+        std::this_thread::sleep_until(next);
+        next += milliseconds(1);
+        for (uint32_t i = 0; i < perTick; i += batchSize) {
+            size_t count = std::min((size_t) (perTick - i), batchSize);
+            batch.clear();
+            for (size_t j = 0; j < count; j++) {
+                DcpPduDatInputOutput &pdu = *pdus[j];
+                pdu.getPduSeqId() = seqId++;
+                int64_t now = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+                std::memcpy(pdu.getPayload(), &now, sizeof(now));
+                batch.push_back(&pdu);
+            }
+            if (batchSize == 1) {
+                sender.send(*batch[0]);
+            } else {
+                sender.sendBatch(batch);
+            }
+            result.sent += count;
+        }
+    }
+    result.senderCpu = threadCpuSeconds() - senderCpu;
+    std::this_thread::sleep_for(milliseconds(300));
+
+    sender.stopReceiving();
+    receiver.stopReceiving();
+    senderThread.join();
+    receiverThread.join();
+    result.received = received;
+    result.errors = errors;
+    result.latency = histogram.snapshot();
+    result.receiverCpu = receiverCpu;
+    return result;
+}
+
+static void connect(DcpDriver &sender, port_t receiverPort) {
+    uint8_t info[6];
+    *((uint16_t *) info) = receiverPort;
+    *((ip_address_t *) (info + 2)) = LOCALHOST;
+    sender.setTargetNetworkInformation(DATA_ID, info);
+}
+
+static void print(const std::string &driver, uint32_t rate, size_t batchSize, const Result &result) {
+    std::printf("%-14s %7u %5zu %9llu %7.3f%% %9.1f %9.1f %9.1f %9.2f %9.2f %6llu\n",
+                driver.c_str(), rate, batchSize, (unsigned long long) result.sent,
+                result.sent == 0 ? 0.0 : 100.0 * (double) (result.sent - result.received) / (double) result.sent,
+                result.latency.getValueAtPercentile(50) / 1e3, result.latency.getValueAtPercentile(99) / 1e3,
+                result.latency.max / 1e3,
+                result.sent == 0 ? 0.0 : result.senderCpu * 1e9 / (double) result.sent / 1e3,
+                result.received == 0 ? 0.0 : result.receiverCpu * 1e9 / (double) result.received / 1e3,
+                (unsigned long long) result.errors);
+    std::fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = 2;
+    unsigned sqPollIdle = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--sqpoll") {
+            sqPollIdle = 100;
+        } else {
+            seconds = std::stod(argv[i]);
+        }
+    }
+    std::printf("%-14s %7s %5s %9s %8s %9s %9s %9s %9s %9s %6s\n", "driver", "PDU/s", "batch", "sent", "lost",
+                "p50 us", "p99 us", "max us", "tx us/PDU", "rx us/PDU", "errors");
+    port_t port = 27000;
+    for (uint32_t rate : {10000, 50000, 100000}) {
+        for (size_t batchSize : {1, 16}) {
+            {
+                UdpDriver sender("127.0.0.1", port);
+                UdpDriver receiver("127.0.0.1", port + 1);
+                DcpDriver senderDriver = sender.getDcpDriver();
+                connect(senderDriver, port + 1);
+                print("UdpDriver", rate, batchSize, run(senderDriver, receiver.getDcpDriver(), rate, batchSize,
+                                                        seconds));
+                port += 2;
+            }
+            {
+                UringUdpDriver sender("127.0.0.1", port);
+                UringUdpDriver receiver("127.0.0.1", port + 1);
+                sender.setSubmissionQueuePolling(sqPollIdle);
+                receiver.setSubmissionQueuePolling(sqPollIdle);
+                DcpDriver senderDriver = sender.getDcpDriver();
+                connect(senderDriver, port + 1);
+                print(sqPollIdle > 0 ? "UringUdp+SQP" : "UringUdpDriver", rate, batchSize,
+                      run(senderDriver, receiver.getDcpDriver(), rate, batchSize, seconds));
+                port += 2;
+            }
+        }
+    }
+    return 0;
+}
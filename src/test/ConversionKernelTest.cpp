@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#include <dcp/helper/ConversionKernels.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "TestCheck.hpp"
+
+//byte size of the numeric data types uint8 to float64, indexed by DcpDataType
+static const size_t typeSizes[] = {1, 2, 4, 8, 1, 2, 4, 8, 4, 8};
+static const uint8_t NUM_NUMERIC_TYPES = 10;
+//covers empty input, the vector loops of width 4 and 8 and every remainder of the scalar tail
+static const size_t MAX_COUNT = 40;
+static const size_t MAX_MISALIGNMENT = 3;
+
+/**
+ * Fills count values of type. Integers get all byte patterns including the extremes,
+ * floating point values stay finite, so the scalar reference is well defined.
+ */
+static void fillSource(uint8_t *source, DcpDataType type, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (type == DcpDataType::float32) {
+            float32_t value = ((float32_t) i - 20.0f) * 1.37e3f;
+            std::memcpy(source + i * 4, &value, 4);
+        } else if (type == DcpDataType::float64) {
+            float64_t value = ((float64_t) i - 20.0) * -7.3e-2;
+            std::memcpy(source + i * 8, &value, 8);
+        } else {
+            for (size_t b = 0; b < typeSizes[(uint8_t) type]; b++) {
+                source[i * typeSizes[(uint8_t) type] + b] = (uint8_t) (i * 37 + b * 101 + (i % 3 == 0 ? 0x80 : 0x7F));
+            }
+        }
+    }
+}
+
+/**
+ * Runs kernel and the scalar kernel of the same conversion on every length up to MAX_COUNT, with source and
+ * destination misaligned by up to MAX_MISALIGNMENT bytes. Non-empty buffers have exactly the needed size, so an
+ * address sanitizer build also catches reads and writes past the end.
+ * @return False if any result differs from the scalar one
+ */
+static bool matchesScalar(ConversionKernel kernel, DcpDataType target, DcpDataType source) {
+    ConversionKernel scalar = getScalarConversionKernel(target, source);
+    size_t sourceSize = typeSizes[(uint8_t) source];
+    size_t targetSize = typeSizes[(uint8_t) target];
+    for (size_t count = 0; count <= MAX_COUNT; count++) {
+        for (size_t offset = 0; offset <= MAX_MISALIGNMENT; offset++) {
+            //at least one byte, so an empty conversion still gets valid pointers
+            std::vector<uint8_t> input(std::max<size_t>(offset + count * sourceSize, 1));
+            fillSource(input.data() + offset, source, count);
+            std::vector<uint8_t> expected(count * targetSize + 1);
+            std::vector<uint8_t> actual(std::max<size_t>(offset + count * targetSize, 1));
+            scalar(expected.data(), input.data() + offset, count);
+            kernel(actual.data() + offset, input.data() + offset, count);
+            if (count > 0 && std::memcmp(expected.data(), actual.data() + offset, count * targetSize) != 0) {
+                std::printf("kernel %u <- %u differs from scalar for count %zu, offset %zu\n", (unsigned) target,
+                            (unsigned) source, count, offset);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    //the kernels selected for the running cpu produce the same values as the scalar path
+    for (uint8_t target = 0; target < NUM_NUMERIC_TYPES; target++) {
+        for (uint8_t source = 0; source < NUM_NUMERIC_TYPES; source++) {
+            ConversionKernel kernel = getConversionKernel((DcpDataType) target, (DcpDataType) source);
+            ConversionKernel scalar = getScalarConversionKernel((DcpDataType) target, (DcpDataType) source);
+            CHECK((kernel == nullptr) == (scalar == nullptr));
+            if (kernel != nullptr && (target == (uint8_t) DcpDataType::float32 ||
+                                      target == (uint8_t) DcpDataType::float64)) {
+                CHECK(matchesScalar(kernel, (DcpDataType) target, (DcpDataType) source));
+            }
+        }
+    }
+
+#ifdef DCPLIB_X86_KERNELS
+    //every vectorized variant supported here, also those not selected because a wider one is available
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        CHECK(matchesScalar(&widenToFloat32Avx2<int8_t>, DcpDataType::float32, DcpDataType::int8));
+        CHECK(matchesScalar(&widenToFloat32Avx2<int16_t>, DcpDataType::float32, DcpDataType::int16));
+        CHECK(matchesScalar(&widenToFloat32Avx2<uint8_t>, DcpDataType::float32, DcpDataType::uint8));
+        CHECK(matchesScalar(&widenToFloat32Avx2<uint16_t>, DcpDataType::float32, DcpDataType::uint16));
+        CHECK(matchesScalar(&widenToFloat64Avx2<int8_t>, DcpDataType::float64, DcpDataType::int8));
+        CHECK(matchesScalar(&widenToFloat64Avx2<int16_t>, DcpDataType::float64, DcpDataType::int16));
+        CHECK(matchesScalar(&widenToFloat64Avx2<int32_t>, DcpDataType::float64, DcpDataType::int32));
+        CHECK(matchesScalar(&widenToFloat64Avx2<uint8_t>, DcpDataType::float64, DcpDataType::uint8));
+        CHECK(matchesScalar(&widenToFloat64Avx2<uint16_t>, DcpDataType::float64, DcpDataType::uint16));
+        CHECK(matchesScalar(&float32ToFloat64Avx2, DcpDataType::float64, DcpDataType::float32));
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        CHECK(matchesScalar(&widenToFloat32Sse<int8_t>, DcpDataType::float32, DcpDataType::int8));
+        CHECK(matchesScalar(&widenToFloat32Sse<int16_t>, DcpDataType::float32, DcpDataType::int16));
+        CHECK(matchesScalar(&widenToFloat32Sse<uint8_t>, DcpDataType::float32, DcpDataType::uint8));
+        CHECK(matchesScalar(&widenToFloat32Sse<uint16_t>, DcpDataType::float32, DcpDataType::uint16));
+        CHECK(matchesScalar(&widenToFloat64Sse<int8_t>, DcpDataType::float64, DcpDataType::int8));
+        CHECK(matchesScalar(&widenToFloat64Sse<int16_t>, DcpDataType::float64, DcpDataType::int16));
+        CHECK(matchesScalar(&widenToFloat64Sse<int32_t>, DcpDataType::float64, DcpDataType::int32));
+        CHECK(matchesScalar(&widenToFloat64Sse<uint8_t>, DcpDataType::float64, DcpDataType::uint8));
+        CHECK(matchesScalar(&widenToFloat64Sse<uint16_t>, DcpDataType::float64, DcpDataType::uint16));
+    }
+    CHECK(matchesScalar(&float32ToFloat64Sse, DcpDataType::float64, DcpDataType::float32));
+#endif
+
+    return testResult("ConversionKernelTest");
+}
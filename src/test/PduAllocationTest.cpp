@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#include <dcp/driver/loopback/LoopbackDriver.hpp>
+#include <dcp/model/pdu/DcpPduDatInputOutput.hpp>
+#include <dcp/model/pdu/DcpPduFactory.hpp>
+#include <dcp/model/pdu/DcpPduStc.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "TestCheck.hpp"
+
+static const dataId_t DATA_ID = 1;
+static const uint16_t PAYLOAD_SIZE = 16;
+static const uint64_t PDUS = 1000;
+
+int main() {
+    using namespace std::chrono;
+
+    //decoding into a slot does not allocate, makeDcpPdu does
+    {
+        DcpPduDatInputOutput data(7, DATA_ID, PAYLOAD_SIZE);
+        DcpPduStc stc(DcpPduType::STC_prepare, 3, 1, DcpState::CONFIGURATION);
+        DcpPduSlot slot;
+        uint64_t before = DcpPdu::getAllocationCount();
+        for (int i = 0; i < 100; i++) {
+            DcpPdu &decodedData = slot.emplace(data.serialize(), data.getPduSize());
+            CHECK(decodedData.getTypeId() == DcpPduType::DAT_input_output);
+            CHECK(static_cast<DcpPduDatInputOutput &>(decodedData).getDataId() == DATA_ID);
+            DcpPdu &decodedStc = slot.emplace(stc.serialize(), stc.getPduSize());
+            CHECK(decodedStc.getTypeId() == DcpPduType::STC_prepare);
+        }
+        CHECK(DcpPdu::getAllocationCount() == before);
+
+        std::unique_ptr<DcpPduDatInputOutput> heap(
+                static_cast<DcpPduDatInputOutput *>(makeDcpPdu(data.serialize(), data.getPduSize())));
+        CHECK(DcpPdu::getAllocationCount() == before + 1);
+    }
+
+    //receiving DAT_input_output PDUs through a driver does not allocate PDUs
+    {
+        LoopbackBroker broker;
+        LoopbackDriver sender(broker, "127.0.0.1", 2000);
+        LoopbackDriver receiver(broker, "127.0.0.1", 2001);
+        LogManager logManager;
+        logManager.alloc = [](size_t size) {
+            static thread_local std::vector<uint8_t> buffer;
+            buffer.resize(size);
+            return buffer.data();
+        };
+        logManager.consume = [](const LogTemplate &, uint8_t *, size_t) {};
+
+        std::atomic<uint64_t> received(0);
+        std::atomic<uint64_t> wrongPayload(0);
+        DcpManager receiverManager;
+        receiverManager.receive = [&received, &wrongPayload](DcpPdu &pdu) {
+            DcpPduDatInputOutput &data = static_cast<DcpPduDatInputOutput &>(pdu);
+            if (pdu.getTypeId() != DcpPduType::DAT_input_output || data.getPayload()[0] != 0x2A) {
+                wrongPayload++;
+            }
+            received++;
+        };
+        receiverManager.reportError = [](DcpError) {};
+        receiverManager.receiveBuffer = nullptr;
+        DcpManager senderManager;
+        senderManager.receive = [](DcpPdu &) {};
+        senderManager.reportError = [](DcpError) {};
+        senderManager.receiveBuffer = nullptr;
+
+        DcpDriver senderDriver = sender.getDcpDriver();
+        DcpDriver receiverDriver = receiver.getDcpDriver();
+        senderDriver.setLogManager(logManager);
+        receiverDriver.setLogManager(logManager);
+        senderDriver.setDcpManager(senderManager);
+        receiverDriver.setDcpManager(receiverManager);
+        uint8_t info[6];
+        *((uint16_t *) info) = 2001;
+        *((ip_address_t *) (info + 2)) = 0x7F000001;
+        senderDriver.setTargetNetworkInformation(DATA_ID, info);
+
+        std::thread receiverThread([&receiverDriver] { receiverDriver.startReceiving(); });
+        std::this_thread::sleep_for(milliseconds(20));
+
+        DcpPduDatInputOutput data(0, DATA_ID, PAYLOAD_SIZE);
+        std::memset(data.getPayload(), 0x2A, PAYLOAD_SIZE);
+        uint64_t before = DcpPdu::getAllocationCount();
+        for (uint64_t i = 0; i < PDUS; i++) {
+            data.getPduSeqId() = (uint16_t) i;
+            senderDriver.send(data);
+            if (i % 100 == 99) {
+                //stay below the capacity of the inbox
+                steady_clock::time_point timeout = steady_clock::now() + seconds(5);
+                while (received < i + 1 && steady_clock::now() < timeout) {
+                    std::this_thread::sleep_for(microseconds(100));
+                }
+            }
+        }
+        CHECK(received == PDUS);
+        CHECK(wrongPayload == 0);
+        CHECK(DcpPdu::getAllocationCount() == before);
+
+        receiverDriver.stopReceiving();
+        receiverThread.join();
+    }
+
+    return testResult("PduAllocationTest");
+}
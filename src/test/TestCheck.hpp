@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#ifndef DCPLIB_TESTCHECK_HPP
+#define DCPLIB_TESTCHECK_HPP
+
+#include <cstdio>
+
+/*
+ * Minimal check helper of the test programs. Each test is a plain main which counts
+ * failed checks and returns testResult, so ctest sees a failure as a non zero exit code.
+ */
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    if (!(condition)) { \
+        std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        failures++; \
+    }
+
+/**
+ * @return Exit code of the test program, 0 if no check failed
+ */
+static int testResult(const char *name) {
+    if (failures == 0) {
+        std::printf("%s passed\n", name);
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+#endif //DCPLIB_TESTCHECK_HPP
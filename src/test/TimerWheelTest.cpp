@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2019, FG Simulation und Modellierung, Leibniz Universitt Hannover, Germany
+ *
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD 3-CLause license.  See the LICENSE file for details.
+ */
+
+#include <dcp/helper/TimerWheel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "TestCheck.hpp"
+
+int main() {
+    using namespace std::chrono;
+
+    //destroying a wheel which never ran
+    {
+        TimerWheel wheel(4);
+    }
+
+    //start, stop explicitly and destroy, as ~DcpManagerMaster does
+    std::atomic<int> calls(0);
+    {
+        TimerWheel wheel(4);
+        wheel.setTimer(0, milliseconds(2), [&calls] { calls++; });
+        std::this_thread::sleep_for(milliseconds(30));
+        wheel.stop();
+        wheel.stop();
+    }
+    CHECK(calls > 1);
+
+    //a stopped wheel has no timers left and can be started again
+    {
+        TimerWheel wheel(4);
+        wheel.setTimer(1, milliseconds(1), [&calls] { calls++; });
+        std::this_thread::sleep_for(milliseconds(10));
+        wheel.stop();
+        int stoppedAt = calls;
+        std::this_thread::sleep_for(milliseconds(10));
+        CHECK(calls == stoppedAt);
+        CHECK(!wheel.cancelTimer(1));
+
+        std::atomic<int> restarted(0);
+        wheel.setTimer(2, milliseconds(1), [&restarted] { restarted++; });
+        std::this_thread::sleep_for(milliseconds(20));
+        CHECK(restarted > 1);
+    }
+
+    //cancelTimer waits for a running callback, no callback runs after it returned
+    {
+        TimerWheel wheel(4);
+        std::atomic<bool> inCallback(false);
+        std::atomic<int> slowCalls(0);
+        wheel.setTimer(0, milliseconds(1), [&inCallback, &slowCalls] {
+            inCallback = true;
+            std::this_thread::sleep_for(milliseconds(20));
+            slowCalls++;
+            inCallback = false;
+        });
+        std::this_thread::sleep_for(milliseconds(5));
+        CHECK(wheel.cancelTimer(0));
+        CHECK(!inCallback);
+        int cancelledAt = slowCalls;
+        std::this_thread::sleep_for(milliseconds(30));
+        CHECK(slowCalls == cancelledAt);
+    }
+
+    //a callback may cancel its own timer
+    {
+        TimerWheel wheel(4);
+        std::atomic<int> selfCalls(0);
+        wheel.setTimer(3, milliseconds(1), [&wheel, &selfCalls] {
+            selfCalls++;
+            wheel.cancelTimer(3);
+        });
+        std::this_thread::sleep_for(milliseconds(20));
+        CHECK(selfCalls == 1);
+    }
+
+    return testResult("TimerWheelTest");
+}